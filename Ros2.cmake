@@ -22,12 +22,14 @@ add_library(${PROJECT_NAME} STATIC ${MY_SOURCES})
 
 # specify include paths and dependencies
 target_include_directories(${PROJECT_NAME} PRIVATE src)
-target_link_libraries(${PROJECT_NAME} PkgConfig::SOEM Eigen3::Eigen)
+target_link_libraries(${PROJECT_NAME} PkgConfig::SOEM Eigen3::Eigen rt)
 ament_target_dependencies(${PROJECT_NAME} rclcpp)
 
 # copy public headers to destination
 install(
-  FILES src/PlatformDriverEthercat.h src/PlatformDriverEthercatTypes.h
+  FILES src/PlatformDriverEthercat.h src/PlatformDriverEthercatTypes.h src/SharedState.h
+        src/SharedCommands.h
+        src/SeqLock.h
   DESTINATION include
 )
 
@@ -40,6 +42,27 @@ install(
   INCLUDES DESTINATION include
 )
 
+if(BUILD_TESTING)
+  find_package(ament_cmake_gtest REQUIRED)
+
+  # the library built against the simulated bus of the tests instead of SOEM
+  add_library(${PROJECT_NAME}_simulated STATIC ${MY_SOURCES} test/SimulatedBus.cpp)
+  target_include_directories(${PROJECT_NAME}_simulated PUBLIC src test test/soem)
+  target_link_libraries(${PROJECT_NAME}_simulated Eigen3::Eigen rt pthread)
+  ament_target_dependencies(${PROJECT_NAME}_simulated rclcpp)
+
+  ament_add_gtest(test_cycle_allocations test/test_cycle_allocations.cpp
+    SKIP_LINKING_MAIN_LIBRARIES)
+  target_link_libraries(test_cycle_allocations ${PROJECT_NAME}_simulated)
+
+  # benchmarks, run by hand on the target machine
+  add_executable(benchmark_drive_inputs test/benchmark_drive_inputs.cpp)
+  target_link_libraries(benchmark_drive_inputs ${PROJECT_NAME}_simulated)
+
+  add_executable(benchmark_cycle_workers test/benchmark_cycle_workers.cpp)
+  target_link_libraries(benchmark_cycle_workers ${PROJECT_NAME}_simulated)
+endif()
+
 # export information for upstream packages
 ament_export_libraries(${PROJECT_NAME})
 ament_export_include_directories(include)
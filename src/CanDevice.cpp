@@ -13,4 +13,4 @@ CanDevice::~CanDevice() {}
 
 unsigned int CanDevice::getSlaveId() { return slave_id_; }
 
-std::string CanDevice::getDeviceName() { return device_name_; }
+const std::string& CanDevice::getDeviceName() const { return device_name_; }
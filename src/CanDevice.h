@@ -7,6 +7,7 @@ namespace platform_driver_ethercat
 {
 
 class EthercatInterface;
+struct CycleInfo;
 
 class CanDevice
 {
@@ -23,8 +24,23 @@ class CanDevice
     virtual void setInputPdo(unsigned char* input_pdo) = 0;
     virtual void setOutputPdo(unsigned char* output_pdo) = 0;
 
+    /**
+     * Processes the inputs received in the current process data cycle.
+     * Called from the process data cycle only.
+     */
+    virtual void update(const CycleInfo& cycle) = 0;
+
+    /**
+     * Performs at most one pending mailbox (SDO) transaction.
+     * Called from the mailbox thread only. The logging streams of the other classes belong to
+     * the application threads, so this and the SDO functions of EthercatInterface it uses format
+     * their messages into local buffers.
+     * @return True if a transaction was performed.
+     */
+    virtual bool processMailbox() = 0;
+
     unsigned int getSlaveId();
-    std::string getDeviceName();
+    const std::string& getDeviceName() const;
 
   protected:
     std::shared_ptr<EthercatInterface> ethercat_;
@@ -1,4 +1,8 @@
+#include <math.h>
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "CanDeviceAtiFts.h"
@@ -17,40 +21,20 @@ CanDeviceAtiFts::CanDeviceAtiFts(std::shared_ptr<EthercatInterface> ethercat,
       output_(NULL),
       counts_per_force_(1),
       counts_per_torque_(1),
-      force_bias_(0, 0, 0),
-      torque_bias_(0, 0, 0)
-
+      stream_initialized_(false),
+      last_sample_count_(0),
+      num_samples_(0),
+      num_missed_samples_(0),
+      num_dropped_samples_(0),
+      status_(),
+      cycles_without_sample_(0),
+      status_changed_(false),
+      filter_(0),
+      bias_request_(false),
+      clear_bias_request_(false),
+      tool_transform_pending_(false),
+      tool_transform_next_sub_(0)
 {
-    if (device_name == "FTS_FL")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
-    else if (device_name == "FTS_FR")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
-    else if (device_name == "FTS_CL")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
-    else if (device_name == "FTS_CR")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
-    else if (device_name == "FTS_BL")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
-    else if (device_name == "FTS_BR")
-    {
-        force_bias_ = Eigen::Vector3d(0, 0, 0);
-        torque_bias_ = Eigen::Vector3d(0, 0, 0);
-    }
 }
 
 CanDeviceAtiFts::~CanDeviceAtiFts() {}
@@ -125,6 +109,217 @@ void CanDeviceAtiFts::setOutputPdo(unsigned char* output_pdo)
     output_->control_2 = 0x00000000;
 }
 
+std::map<std::string, int> CanDeviceAtiFts::addTelemetry()
+{
+    std::map<std::string, int> telemetry_ids;
+
+    for (uint8_t sub = 1; sub <= 6; sub++)
+    {
+        telemetry_ids["diagnostic_reading_" + std::to_string(sub)] = ethercat_->addTelemetry(
+            slave_id_, DictionaryObject::DIAGNOSTIC_READINGS, sub, TelemetryType::INT32, 1.0);
+    }
+
+    return telemetry_ids;
+}
+
+void CanDeviceAtiFts::update(const CycleInfo& cycle)
+{
+    // bias and clear bias are set for a single cycle, the sensor reacts on the rising edge
+    uint32_t control_1 = (filter_.load(std::memory_order_relaxed) << CONTROL_FILTER_SHIFT)
+                         & CONTROL_FILTER_MASK;
+
+    if (bias_request_.exchange(false, std::memory_order_relaxed))
+    {
+        control_1 |= CONTROL_BIAS;
+    }
+
+    if (clear_bias_request_.exchange(false, std::memory_order_relaxed))
+    {
+        control_1 |= CONTROL_CLEAR_BIAS;
+    }
+
+    output_->control_1 = control_1;
+
+    uint32_t sample_count = input_->sample_count;
+    bool new_sample = !stream_initialized_ || sample_count != last_sample_count_;
+
+    updateStatus(new_sample);
+
+    if (!new_sample) return;
+
+    FtsSample sample;
+    sample.stamp = cycle.getStamp();
+    sample.sample_count = sample_count;
+    sample.status_code = input_->status_code;
+    sample.fx = input_->fx * 1.0 / counts_per_force_;
+    sample.fy = input_->fy * 1.0 / counts_per_force_;
+    sample.fz = input_->fz * 1.0 / counts_per_force_;
+    sample.tx = input_->tx * 1.0 / counts_per_torque_;
+    sample.ty = input_->ty * 1.0 / counts_per_torque_;
+    sample.tz = input_->tz * 1.0 / counts_per_torque_;
+
+    wrench_.write(sample);
+
+    if (!stream_initialized_)
+    {
+        last_sample_count_ = sample_count;
+        stream_initialized_ = true;
+        return;
+    }
+
+    uint32_t delta = sample_count - last_sample_count_;
+    last_sample_count_ = sample_count;
+
+    if (delta > 1)
+    {
+        num_missed_samples_.fetch_add(delta - 1, std::memory_order_relaxed);
+    }
+
+    if (samples_.push(sample))
+        num_samples_.fetch_add(1, std::memory_order_relaxed);
+    else
+        num_dropped_samples_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CanDeviceAtiFts::updateStatus(bool new_sample)
+{
+    uint32_t status_code = input_->status_code;
+
+    FtsStatus status = status_;
+    status.status_code = status_code;
+    status.error = status_code & STATUS_ERROR;
+    status.saturated = status_code & STATUS_GAUGE_SATURATION;
+    status.gauge_fault = status_code & (STATUS_ADC_HIGH | STATUS_ADC_LOW | STATUS_ANALOG_GROUND);
+    status.supply_fault = status_code & (STATUS_SUPPLY_HIGH | STATUS_SUPPLY_LOW);
+    status.calibration_fault = status_code
+                               & (STATUS_BAD_CALIBRATION | STATUS_EEPROM_FAILURE
+                                  | STATUS_CONFIGURATION_INVALID | STATUS_CALIBRATION_CHECKSUM);
+
+    cycles_without_sample_ = new_sample ? 0 : cycles_without_sample_ + 1;
+    status.stale = cycles_without_sample_ >= STALE_CYCLES;
+
+    if (status.error && !status_.error) status.num_errors++;
+    if (status.saturated && !status_.saturated) status.num_saturations++;
+    if (status.stale && !status_.stale) status.num_stale++;
+
+    bool changed = status.error != status_.error || status.saturated != status_.saturated
+                   || status.gauge_fault != status_.gauge_fault
+                   || status.supply_fault != status_.supply_fault
+                   || status.calibration_fault != status_.calibration_fault
+                   || status.stale != status_.stale;
+
+    status_ = status;
+    status_published_.write(status);
+
+    if (changed) status_changed_ = true;
+}
+
+FtsStatus CanDeviceAtiFts::readStatus() { return status_published_.read(); }
+
+void CanDeviceAtiFts::setStatusCallback(std::function<void(const FtsStatus&)> callback)
+{
+    status_callback_ = std::move(callback);
+}
+
+void CanDeviceAtiFts::notifyStatus()
+{
+    if (!status_changed_) return;
+
+    status_changed_ = false;
+
+    if (status_callback_)
+    {
+        status_callback_(status_);
+    }
+}
+
+void CanDeviceAtiFts::readSamples(std::vector<FtsSample>& samples)
+{
+    std::unique_lock<std::mutex> lock(samples_mutex_);
+
+    FtsSample sample;
+
+    while (samples_.pop(sample))
+    {
+        samples.push_back(sample);
+    }
+}
+
+FtsStreamStats CanDeviceAtiFts::readStreamStats()
+{
+    return FtsStreamStats{num_samples_.load(std::memory_order_relaxed),
+                          num_missed_samples_.load(std::memory_order_relaxed),
+                          num_dropped_samples_.load(std::memory_order_relaxed)};
+}
+
+bool CanDeviceAtiFts::processMailbox()
+{
+    // write the tool transformation one subindex per transaction
+    if (tool_transform_next_sub_ == 0)
+    {
+        if (!tool_transform_pending_.exchange(false)) return false;
+
+        std::unique_lock<std::mutex> lock(tool_transform_mutex_);
+        std::copy(tool_transform_, tool_transform_ + 8, tool_transform_writes_);
+        tool_transform_next_sub_ = TOOL_DISTANCE_UNITS;
+    }
+
+    uint8_t sub = tool_transform_next_sub_;
+
+    if (!ethercat_->sdoWrite(slave_id_,
+                             DictionaryObject::TOOL_TRANSFORMATION,
+                             sub,
+                             4,
+                             tool_transform_writes_[sub - 1]))
+    {
+        char message[128];
+        snprintf(message,
+                 sizeof(message),
+                 "Failed to set tool transformation of sensor %s",
+                 device_name_.c_str());
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, message);
+        tool_transform_next_sub_ = 0;
+        return true;
+    }
+
+    tool_transform_next_sub_ = (sub == TOOL_RZ) ? 0 : sub + 1;
+
+    return true;
+}
+
+bool CanDeviceAtiFts::commandFilter(unsigned int filter)
+{
+    if (filter > MAX_FILTER) return false;
+
+    filter_.store(filter, std::memory_order_relaxed);
+
+    return true;
+}
+
+void CanDeviceAtiFts::commandBias() { bias_request_.store(true, std::memory_order_relaxed); }
+
+void CanDeviceAtiFts::commandClearBias()
+{
+    clear_bias_request_.store(true, std::memory_order_relaxed);
+}
+
+void CanDeviceAtiFts::commandToolTransform(const Eigen::Vector3d& translation_m,
+                                           const Eigen::Vector3d& rotation_rad)
+{
+    std::unique_lock<std::mutex> lock(tool_transform_mutex_);
+
+    tool_transform_[TOOL_DISTANCE_UNITS - 1] = TOOL_UNITS_MM;
+    tool_transform_[TOOL_ANGLE_UNITS - 1] = TOOL_UNITS_DEG;
+
+    for (int i = 0; i < 3; i++)
+    {
+        tool_transform_[TOOL_DX - 1 + i] = (int32_t)lround(translation_m[i] * 1000.0 * 100.0);
+        tool_transform_[TOOL_RX - 1 + i] = (int32_t)lround(rotation_rad[i] * 180.0 / M_PI * 100.0);
+    }
+
+    tool_transform_pending_.store(true);
+}
+
 bool CanDeviceAtiFts::startup() { return true; }
 
 bool CanDeviceAtiFts::shutdown() { return true; }
@@ -133,28 +328,26 @@ bool CanDeviceAtiFts::reset() { return shutdown() && startup(); }
 
 Eigen::Vector3d CanDeviceAtiFts::readForceN()
 {
-    double fx = input_->fx * 1.0 / counts_per_force_;
-    double fy = input_->fy * 1.0 / counts_per_force_;
-    double fz = input_->fz * 1.0 / counts_per_force_;
+    FtsSample wrench = wrench_.read();
 
-    Eigen::Vector3d force = Eigen::Vector3d(fx, fy, fz);
-    force -= force_bias_;
-
-    return force;
+    return Eigen::Vector3d(wrench.fx, wrench.fy, wrench.fz);
 }
 
 Eigen::Vector3d CanDeviceAtiFts::readTorqueNm()
 {
-    double tx = input_->tx * 1.0 / counts_per_torque_;
-    double ty = input_->ty * 1.0 / counts_per_torque_;
-    double tz = input_->tz * 1.0 / counts_per_torque_;
-
-    Eigen::Vector3d torque = Eigen::Vector3d(tx, ty, tz);
-    torque -= torque_bias_;
+    FtsSample wrench = wrench_.read();
 
-    return torque;
+    return Eigen::Vector3d(wrench.tx, wrench.ty, wrench.tz);
 }
 
-bool CanDeviceAtiFts::isError() { return false; }
+FtsSample CanDeviceAtiFts::readWrench() { return wrench_.read(); }
+
+bool CanDeviceAtiFts::isError()
+{
+    FtsStatus status = status_published_.read();
+
+    return status.error || status.saturated || status.gauge_fault || status.supply_fault
+           || status.calibration_fault || status.stale;
+}
 
-unsigned int CanDeviceAtiFts::getError() { return 0; }
+unsigned int CanDeviceAtiFts::getError() { return status_published_.read().status_code; }
@@ -1,7 +1,15 @@
 #pragma once
 
 #include <Eigen/Dense>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
 #include "CanDevice.h"
+#include "PlatformDriverEthercatTypes.h"
+#include "SeqLock.h"
+#include "SpscQueue.h"
 
 namespace platform_driver_ethercat
 {
@@ -27,6 +35,8 @@ class CanDeviceAtiFts : public CanDevice
     bool configure();
     void setInputPdo(unsigned char* input_pdo);
     void setOutputPdo(unsigned char* output_pdo);
+    void update(const CycleInfo& cycle);
+    bool processMailbox();
 
     /**
      * Brings the drive to operation enable state.
@@ -52,6 +62,53 @@ class CanDeviceAtiFts : public CanDevice
     Eigen::Vector3d readForceN();
     Eigen::Vector3d readTorqueNm();
 
+    /**
+     * Returns force, torque, status and sample counter of the last received sample.
+     * All values stem from the same process data cycle.
+     */
+    FtsSample readWrench();
+
+    /**
+     * Drains all samples received since the last call.
+     * @param samples Samples in the order of reception, appended to the vector.
+     */
+    void readSamples(std::vector<FtsSample>& samples);
+
+    /**
+     * Returns the statistics of the sample stream.
+     */
+    FtsStreamStats readStreamStats();
+
+    /**
+     * Selects the low-pass filter of the sensor firmware.
+     * Takes effect in the next process data cycle.
+     * @param filter 0 disables filtering, 1 to 8 select decreasing cut-off frequencies, see the
+     * sensor manual.
+     * @return False if the filter is out of range.
+     */
+    bool commandFilter(unsigned int filter);
+
+    /**
+     * Biases (tares) the sensor in firmware with the current load.
+     * The bias bit is set for exactly one process data cycle.
+     */
+    void commandBias();
+
+    /**
+     * Removes the firmware bias of the sensor.
+     * The clear bias bit is set for exactly one process data cycle.
+     */
+    void commandClearBias();
+
+    /**
+     * Sets the tool transformation applied by the sensor firmware.
+     * The transformation is written over the mailbox in the background.
+     * @param translation_m Translation of the tool frame in meters.
+     * @param rotation_rad Rotation of the tool frame about x, y and z in radians.
+     */
+    void commandToolTransform(const Eigen::Vector3d& translation_m,
+                              const Eigen::Vector3d& rotation_rad);
+
     /**
      * Returns true if an error has been detected.
      * @return boolean with result.
@@ -64,6 +121,31 @@ class CanDeviceAtiFts : public CanDevice
      */
     unsigned int getError();
 
+    /**
+     * Returns the status flags and counters decoded in the process data cycle.
+     */
+    FtsStatus readStatus();
+
+    /**
+     * Sets a callback executed by notifyStatus whenever a status flag changes.
+     * Can only be set before the EtherCAT interface is initialized.
+     */
+    void setStatusCallback(std::function<void(const FtsStatus&)> callback);
+
+    /**
+     * Executes the status callback if a status flag changed in the last update.
+     * Called by the cycle thread after all devices were updated, so the callback never runs on
+     * a worker thread.
+     */
+    void notifyStatus();
+
+    /**
+     * Registers the raw diagnostic readings (0x2080) as telemetry, see the sensor manual for the
+     * meaning of each subindex.
+     * @return Telemetry identifiers by name.
+     */
+    std::map<std::string, int> addTelemetry();
+
   private:
     enum DictionaryObject
     {
@@ -96,13 +178,87 @@ class CanDeviceAtiFts : public CanDevice
         uint32_t control_2;
     } RxPdo;
 
+    // bits of control code 1
+    static const uint32_t CONTROL_BIAS = 0x00000001;
+    static const uint32_t CONTROL_CLEAR_BIAS = 0x00000002;
+    static const uint32_t CONTROL_FILTER_SHIFT = 4;
+    static const uint32_t CONTROL_FILTER_MASK = 0x000000f0;
+    static const unsigned int MAX_FILTER = 8;
+
+    // subindices of the tool transformation
+    enum ToolTransformation
+    {
+        TOOL_DISTANCE_UNITS = 1,
+        TOOL_ANGLE_UNITS = 2,
+        TOOL_DX = 3,
+        TOOL_DY = 4,
+        TOOL_DZ = 5,
+        TOOL_RX = 6,
+        TOOL_RY = 7,
+        TOOL_RZ = 8,
+    };
+
+    // bits of the status code
+    static const uint32_t STATUS_ADC_HIGH = 0x00000002;
+    static const uint32_t STATUS_ADC_LOW = 0x00000004;
+    static const uint32_t STATUS_ANALOG_GROUND = 0x00000008;
+    static const uint32_t STATUS_SUPPLY_HIGH = 0x00000010;
+    static const uint32_t STATUS_SUPPLY_LOW = 0x00000020;
+    static const uint32_t STATUS_BAD_CALIBRATION = 0x00000040;
+    static const uint32_t STATUS_EEPROM_FAILURE = 0x00000080;
+    static const uint32_t STATUS_CONFIGURATION_INVALID = 0x00000100;
+    static const uint32_t STATUS_GAUGE_SATURATION = 0x00020000;
+    static const uint32_t STATUS_CALIBRATION_CHECKSUM = 0x20000000;
+    static const uint32_t STATUS_ERROR = 0x80000000;
+
+    // number of cycles without a new sample after which the data is stale
+    static const unsigned int STALE_CYCLES = 10;
+
+    // unit codes of the tool transformation, values are transferred in hundredths
+    static const int32_t TOOL_UNITS_MM = 3;
+    static const int32_t TOOL_UNITS_DEG = 1;
+
     TxPdo* input_;
     RxPdo* output_;
 
     int counts_per_force_;
     int counts_per_torque_;
 
-    Eigen::Vector3d force_bias_;
-    Eigen::Vector3d torque_bias_;
+    // sample stream, produced by the process data cycle
+    static const size_t SAMPLE_QUEUE_SIZE = 1024;
+
+    bool stream_initialized_;
+    uint32_t last_sample_count_;
+    SpscQueue<FtsSample, SAMPLE_QUEUE_SIZE> samples_;
+    std::mutex samples_mutex_;  // serializes consumers
+    std::atomic<uint64_t> num_samples_;
+    std::atomic<uint64_t> num_missed_samples_;
+    std::atomic<uint64_t> num_dropped_samples_;
+
+    // last sample, published by the process data cycle
+    SeqLock<FtsSample> wrench_;
+
+    // status monitoring, owned by the process data cycle
+    FtsStatus status_;
+    unsigned int cycles_without_sample_;
+    std::function<void(const FtsStatus&)> status_callback_;
+    bool status_changed_;  // since the last notifyStatus
+    SeqLock<FtsStatus> status_published_;
+
+    /**
+     * Decodes the status code and detects stale data.
+     */
+    void updateStatus(bool new_sample);
+
+    // firmware operations requested by the application
+    std::atomic<unsigned int> filter_;
+    std::atomic<bool> bias_request_;
+    std::atomic<bool> clear_bias_request_;
+    std::mutex tool_transform_mutex_;
+    int32_t tool_transform_[8];
+    std::atomic<bool> tool_transform_pending_;
+    // owned by the mailbox thread
+    int32_t tool_transform_writes_[8];
+    unsigned int tool_transform_next_sub_;
 };
 }
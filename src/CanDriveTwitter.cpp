@@ -1,6 +1,7 @@
 #include <math.h>
 #include <unistd.h>
 #include <bitset>
+#include <cstdio>
 #include <iostream>
 #include <vector>
 
@@ -10,6 +11,12 @@
 #include <sstream>
 static std::stringstream ss;
 
+// default resolution of the single-turn auxiliary encoder
+static const int32_t AUX_ENCODER_INCREMENTS = 4096;
+
+// time a drive gets to change the operation mode and to acknowledge a set point
+static const double COMMAND_TIMEOUT_SEC = 0.1;
+
 using namespace platform_driver_ethercat;
 
 CanDriveTwitter::CanDriveTwitter(std::shared_ptr<EthercatInterface> ethercat,
@@ -20,8 +27,49 @@ CanDriveTwitter::CanDriveTwitter(std::shared_ptr<EthercatInterface> ethercat,
       params_(params),
       input_(NULL),
       output_(NULL),
-      command_thread_(&CanDriveTwitter::commandSetPoint, this)
+      aux_encoder_increments_(params.auxiliary_encoder_increments != 0
+                                  ? params.auxiliary_encoder_increments
+                                  : AUX_ENCODER_INCREMENTS),
+      aux_filter_alpha_(0.3),
+      aux_filter_beta_(0.05),
+      inputs_initialized_(false),
+      last_position_inc_(0),
+      last_aux_position_inc_(0),
+      position_unwrapped_inc_(0),
+      aux_unwrapped_inc_(0),
+      aux_last_time_sec_(0.0),
+      aux_position_est_inc_(0.0),
+      aux_velocity_est_inc_sec_(0.0),
+      aux_velocity_rad_sec_(0.0),
+      position_inc_(0),
+      velocity_inc_(0),
+      torque_(0),
+      aux_position_inc_(0),
+      analog_input_(0),
+      history_next_(0),
+      history_size_(0),
+      in_fault_(false),
+      command_sequence_(0),
+      command_(Command{0, 0, 0}),
+      applied_command_sequence_(0),
+      command_mode_(OM_PROFILE_POSITION),
+      command_mode_pending_(false),
+      command_time_sec_(0.0),
+      set_point_state_(SP_IDLE),
+      set_point_time_sec_(0.0),
+      braking_direction_(0),
+      braking_operation_mode_(OM_CYCSYNC_TORQUE),
+      braking_target_torque_(0),
+      braking_target_velocity_(0)
 {
+    double position_increments =
+        (params_.encoder_on_output ? 1.0 : params_.gear_ratio) * params_.encoder_increments;
+
+    scales_.position_rad = 2.0 * M_PI / position_increments;
+    scales_.velocity_rad_sec = 2.0 * M_PI / position_increments;
+    scales_.torque_nm = params_.motor_rated_torque_nm / 1000.0 * params_.gear_ratio;
+    scales_.aux_position_rad = 2.0 * M_PI / aux_encoder_increments_;
+    scales_.analog_input_v = 1.0 / 1000.0;
 }
 
 CanDriveTwitter::~CanDriveTwitter() {}
@@ -168,6 +216,170 @@ void CanDriveTwitter::setOutputPdo(unsigned char* output_pdo)
     output_->target_torque = 0;
 }
 
+void CanDriveTwitter::update(const CycleInfo& cycle)
+{
+    updateCommand(cycle);
+
+    int32_t position_inc = input_->actual_position;
+    int32_t aux_inc = input_->auxiliary_position;
+
+    if (!inputs_initialized_)
+    {
+        last_position_inc_ = position_inc;
+        last_aux_position_inc_ = aux_inc;
+        position_unwrapped_inc_ = position_inc;
+        aux_unwrapped_inc_ = aux_inc;
+        aux_last_time_sec_ = cycle.time_sec;
+        aux_position_est_inc_ = aux_inc;
+        aux_velocity_est_inc_sec_ = 0.0;
+        inputs_initialized_ = true;
+
+        storeInputs();
+        return;
+    }
+
+    // unwrap the 32 bit counter, the difference is exact in modular arithmetic
+    position_unwrapped_inc_ +=
+        (int32_t)((uint32_t)position_inc - (uint32_t)last_position_inc_);
+    last_position_inc_ = position_inc;
+
+    // unwrap the single-turn encoder, assuming less than half a turn per cycle
+    int32_t delta_inc = aux_inc - last_aux_position_inc_;
+    if (delta_inc >= aux_encoder_increments_ / 2)
+        delta_inc -= aux_encoder_increments_;
+    else if (delta_inc < -aux_encoder_increments_ / 2)
+        delta_inc += aux_encoder_increments_;
+
+    aux_unwrapped_inc_ += delta_inc;
+    last_aux_position_inc_ = aux_inc;
+
+    storeInputs();
+
+    updateDiagnostics(cycle);
+
+    double dt = cycle.time_sec - aux_last_time_sec_;
+
+    if (dt <= 0.0) return;
+
+    aux_last_time_sec_ = cycle.time_sec;
+
+    // alpha-beta tracker
+    double predicted_inc = aux_position_est_inc_ + aux_velocity_est_inc_sec_ * dt;
+    double residual_inc = aux_unwrapped_inc_ - predicted_inc;
+
+    aux_position_est_inc_ = predicted_inc + aux_filter_alpha_ * residual_inc;
+    aux_velocity_est_inc_sec_ += aux_filter_beta_ * residual_inc / dt;
+
+    aux_velocity_rad_sec_.store(aux_velocity_est_inc_sec_ * scales_.aux_position_rad,
+                                std::memory_order_relaxed);
+}
+
+void CanDriveTwitter::storeInputs()
+{
+    position_inc_.store(position_unwrapped_inc_, std::memory_order_relaxed);
+    velocity_inc_.store(input_->actual_velocity, std::memory_order_relaxed);
+    torque_.store(input_->actual_torque, std::memory_order_relaxed);
+    aux_position_inc_.store(aux_unwrapped_inc_, std::memory_order_relaxed);
+    analog_input_.store(input_->analog_input, std::memory_order_relaxed);
+}
+
+void CanDriveTwitter::updateDiagnostics(const CycleInfo& cycle)
+{
+    uint16_t status_word = input_->status_word;
+
+    DriveSample& sample = history_[history_next_];
+    sample.time_sec = cycle.time_sec;
+    sample.status_word = status_word;
+    sample.position_rad = position_unwrapped_inc_ * scales_.position_rad;
+    sample.velocity_rad_sec = input_->actual_velocity * scales_.velocity_rad_sec;
+    sample.torque_nm = input_->actual_torque * scales_.torque_nm;
+
+    history_next_ = (history_next_ + 1) % FAULT_HISTORY_LENGTH;
+    if (history_size_ < FAULT_HISTORY_LENGTH) history_size_++;
+
+    DriveState state = decodeDriveState(status_word);
+    bool in_fault = (state == ST_FAULT_REACTION_ACTIVE) || (state == ST_FAULT);
+
+    if (in_fault && !in_fault_)
+    {
+        // the snapshot is completed with the error code by the mailbox thread
+        FaultSnapshot snapshot;
+        snapshot.time_sec = cycle.time_sec;
+        snapshot.status_word = status_word;
+        snapshot.num_samples = history_size_;
+
+        unsigned int first =
+            (history_next_ + FAULT_HISTORY_LENGTH - history_size_) % FAULT_HISTORY_LENGTH;
+
+        for (unsigned int i = 0; i < history_size_; i++)
+        {
+            snapshot.history[i] = history_[(first + i) % FAULT_HISTORY_LENGTH];
+        }
+
+        fault_snapshots_.push(snapshot);
+    }
+
+    in_fault_ = in_fault;
+}
+
+bool CanDriveTwitter::processMailbox()
+{
+    FaultSnapshot snapshot;
+
+    if (!fault_snapshots_.pop(snapshot)) return false;
+
+    int error_code = 0;
+    bool error_code_valid =
+        ethercat_->sdoRead(slave_id_, (uint16_t)DriveObject::ERROR_CODE, 0, &error_code);
+
+    DriveFaultRecord record;
+    record.time_sec = snapshot.time_sec;
+    record.status_word = snapshot.status_word;
+    record.error_code = (uint16_t)error_code;
+    record.error_code_valid = error_code_valid;
+    record.history.assign(snapshot.history, snapshot.history + snapshot.num_samples);
+
+    char message[128];
+    snprintf(message,
+             sizeof(message),
+             "Drive %s faulted with error code 0x%x",
+             device_name_.c_str(),
+             error_code);
+    log(LogLevel::ERROR, __PRETTY_FUNCTION__, message);
+
+    std::unique_lock<std::mutex> lock(fault_records_mutex_);
+
+    fault_records_.push_back(std::move(record));
+
+    if (fault_records_.size() > MAX_FAULT_RECORDS)
+    {
+        fault_records_.pop_front();
+    }
+
+    return true;
+}
+
+void CanDriveTwitter::readFaultRecords(std::vector<DriveFaultRecord>& records)
+{
+    std::unique_lock<std::mutex> lock(fault_records_mutex_);
+
+    records.assign(fault_records_.begin(), fault_records_.end());
+}
+
+std::map<std::string, int> CanDriveTwitter::addTelemetry()
+{
+    std::map<std::string, int> telemetry_ids;
+
+    telemetry_ids["dc_link_voltage_v"] = ethercat_->addTelemetry(
+        slave_id_, (uint16_t)DriveObject::DC_LINK_CIRCUIT_VOLTAGE, 0, TelemetryType::UINT32, 0.001);
+    telemetry_ids["drive_temp_deg_c"] = ethercat_->addTelemetry(
+        slave_id_, (uint16_t)DriveObject::TEMPERATURE, 1, TelemetryType::INT16, 1.0);
+    telemetry_ids["error_code"] = ethercat_->addTelemetry(
+        slave_id_, (uint16_t)DriveObject::ERROR_CODE, 0, TelemetryType::UINT16, 1.0);
+
+    return telemetry_ids;
+}
+
 bool CanDriveTwitter::startup()
 {
     ss << "Starting up drive " << device_name_ << " ...";
@@ -277,125 +489,232 @@ CanDriveTwitter::OperationMode CanDriveTwitter::readOperationMode()
     return (OperationMode)input_->operation_mode_display;
 }
 
-bool CanDriveTwitter::commandOperationMode(CanDriveTwitter::OperationMode mode)
+void CanDriveTwitter::submitCommand(OperationMode mode, int32_t target)
 {
-    OperationMode current_mode = readOperationMode();
+    uint16_t sequence = command_sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
 
-    if (current_mode == mode)
-    {
-        return true;
-    }
-
-    output_->operation_mode = mode;
+    command_.store(Command{target, sequence, (uint16_t)mode}, std::memory_order_release);
+}
 
-    int cnt = 100;
+void CanDriveTwitter::updateCommand(const CycleInfo& cycle)
+{
+    char message[128];
+    Command command = command_.load(std::memory_order_acquire);
 
-    while (current_mode != mode)
+    if (command.sequence != applied_command_sequence_)
     {
-        if (cnt-- == 0)
+        applied_command_sequence_ = command.sequence;
+        command_mode_ = (OperationMode)command.operation_mode;
+        command_mode_pending_ = readOperationMode() != command_mode_;
+        command_time_sec_ = cycle.time_sec;
+
+        output_->operation_mode = command.operation_mode;
+
+        switch (command_mode_)
         {
-            ss << "Could not set operation mode for drive "
-                        << device_name_ << ". Current mode is " << current_mode
-                        << ". Requested mode is " << mode << ".";
-            log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
-            ss.str(""); ss.clear();
-            return false;
+            case OM_PROFILE_POSITION:
+                // replaces a set point that is still being acknowledged
+                output_->target_position = command.target;
+                output_->control_word &= 0xffef;  // no new set point
+                set_point_state_ = SP_WAIT_READY;
+                set_point_time_sec_ = cycle.time_sec;
+                break;
+            case OM_PROFILE_VELOCITY:
+                output_->target_velocity = command.target;
+                break;
+            case OM_PROFILE_TORQUE:
+                output_->target_torque = command.target;
+                break;
+            default:
+                break;
         }
-
-        usleep(1000);  // sleep 0.001 s
-        current_mode = readOperationMode();
     }
 
-    ss << "Successfully changed operation mode for drive "
-                << device_name_ << " to " << current_mode;
-    log(LogLevel::DEBUG, __PRETTY_FUNCTION__, ss.str());
-    ss.str(""); ss.clear();
-
-    return true;
-}
-
-void CanDriveTwitter::commandSetPoint()
-{
-    std::unique_lock<std::mutex> lock(command_mutex_);
+    OperationMode mode = readOperationMode();
 
-    while (1)
+    if (command_mode_pending_)
     {
-        command_cv_.wait(lock);
+        if (mode == command_mode_)
+        {
+            snprintf(message,
+                     sizeof(message),
+                     "Successfully changed operation mode for drive %s to %d",
+                     device_name_.c_str(),
+                     mode);
+            log(LogLevel::DEBUG, __PRETTY_FUNCTION__, message);
+            command_mode_pending_ = false;
+        }
+        else if (cycle.time_sec - command_time_sec_ > COMMAND_TIMEOUT_SEC)
+        {
+            snprintf(message,
+                     sizeof(message),
+                     "Could not set operation mode for drive %s. Current mode is %d. "
+                     "Requested mode is %d.",
+                     device_name_.c_str(),
+                     mode,
+                     command_mode_);
+            log(LogLevel::ERROR, __PRETTY_FUNCTION__, message);
+            command_mode_pending_ = false;
+        }
+    }
 
-        int cnt = 100;
+    bool timeout = cycle.time_sec - set_point_time_sec_ > COMMAND_TIMEOUT_SEC;
 
-        while (checkSetPointAcknowledge())
-        {
-            if (cnt-- == 0)
+    switch (set_point_state_)
+    {
+        case SP_IDLE:
+            break;
+        case SP_WAIT_READY:
+            if (mode != OM_PROFILE_POSITION)
             {
-                ss << "Drive " << device_name_
-                            << " not ready for new set point";
-                log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
-                ss.str(""); ss.clear();
+                // the mode change failed or a cyclic set point took over
+                if (timeout) set_point_state_ = SP_IDLE;
                 break;
             }
 
-            usleep(1000);  // sleep 0.001 s
-        }
-
-        output_->control_word |= 0x0030;  // new set point & change set point immediately
+            if (checkSetPointAcknowledge() && !timeout) break;
 
-        cnt = 100;
+            if (checkSetPointAcknowledge())
+            {
+                snprintf(message,
+                         sizeof(message),
+                         "Drive %s not ready for new set point",
+                         device_name_.c_str());
+                log(LogLevel::ERROR, __PRETTY_FUNCTION__, message);
+            }
 
-        while (!checkSetPointAcknowledge())
-        {
-            // LOG_DEBUG_S << __PRETTY_FUNCTION__ << "Drive " << device_name_ << " Position "
-            //           << position_inc << " Time "
-            //           << std::chrono::duration_cast<std::chrono::milliseconds>(
-            //                  std::chrono::system_clock::now().time_since_epoch())
-            //                  .count();
+            output_->control_word |= 0x0030;  // new set point & change set point immediately
+            set_point_state_ = SP_WAIT_ACK;
+            set_point_time_sec_ = cycle.time_sec;
+            break;
+        case SP_WAIT_ACK:
+            if (!checkSetPointAcknowledge() && !timeout) break;
 
-            if (cnt-- == 0)
+            if (!checkSetPointAcknowledge())
             {
-                ss << "New set point " << output_->target_position
-                            << " was not acknowledged by drive " << device_name_;
-                log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
-                ss.str(""); ss.clear();
-                break;
+                snprintf(message,
+                         sizeof(message),
+                         "New set point %d was not acknowledged by drive %s",
+                         output_->target_position,
+                         device_name_.c_str());
+                log(LogLevel::ERROR, __PRETTY_FUNCTION__, message);
             }
 
-            usleep(1000);  // sleep 0.001 s
-        }
-
-        output_->control_word &= 0xffef;  // no new set point
+            output_->control_word &= 0xffef;  // no new set point
+            set_point_state_ = SP_IDLE;
+            break;
     }
 }
 
 void CanDriveTwitter::commandPositionRad(double position_rad)
 {
-    std::unique_lock<std::mutex> lock(command_mutex_);
+    submitCommand(OM_PROFILE_POSITION, toDrivePositionInc(position_rad));
+}
 
-    double position_inc = position_rad * (params_.encoder_on_output ? 1.0 : params_.gear_ratio)
-                          * params_.encoder_increments / (2.0 * M_PI);
-    output_->target_position = position_inc;
-    commandOperationMode(OM_PROFILE_POSITION);
-    // commandOperationMode(OM_CYCSYNC_POSITION);
+void CanDriveTwitter::commandVelocityRadSec(double velocity_rad_sec)
+{
+    submitCommand(OM_PROFILE_VELOCITY, velocity_rad_sec / scales_.velocity_rad_sec);
+}
 
-    command_cv_.notify_one();
+void CanDriveTwitter::commandTorqueNm(double torque_nm)
+{
+    submitCommand(OM_PROFILE_TORQUE, torque_nm / scales_.torque_nm);
 }
 
-void CanDriveTwitter::commandVelocityRadSec(double velocity_rad_sec)
+void CanDriveTwitter::writeCyclicPositionRad(double position_rad)
+{
+    output_->target_position = toDrivePositionInc(position_rad);
+    output_->operation_mode = OM_CYCSYNC_POSITION;
+}
+
+void CanDriveTwitter::writeCyclicVelocityRadSec(double velocity_rad_sec)
 {
-    std::unique_lock<std::mutex> lock(command_mutex_);
+    output_->target_velocity = velocity_rad_sec / scales_.velocity_rad_sec;
+    output_->operation_mode = OM_CYCSYNC_VELOCITY;
+}
 
-    double velocity_inc = velocity_rad_sec * (params_.encoder_on_output ? 1.0 : params_.gear_ratio)
-                          * params_.encoder_increments / (2.0 * M_PI);
-    output_->target_velocity = velocity_inc;
-    commandOperationMode(OM_PROFILE_VELOCITY);
+void CanDriveTwitter::writeCyclicTorqueNm(double torque_nm)
+{
+    output_->target_torque = torque_nm / scales_.torque_nm;
+    output_->operation_mode = OM_CYCSYNC_TORQUE;
 }
 
-void CanDriveTwitter::commandTorqueNm(double torque_nm)
+void CanDriveTwitter::limitVelocityRadSec(double min_velocity_rad_sec, double max_velocity_rad_sec)
+{
+    double velocity_rad_sec = readVelocityRadSec();
+
+    if (braking_direction_ != 0 && output_->operation_mode == OM_CYCSYNC_VELOCITY
+        && output_->target_velocity == braking_target_velocity_)
+    {
+        // no new set point was written in this cycle, check the replaced torque again
+        output_->operation_mode = braking_operation_mode_;
+        output_->target_torque = braking_target_torque_;
+    }
+
+    int8_t braking_direction = 0;
+
+    switch (output_->operation_mode)
+    {
+        case OM_PROFILE_VELOCITY:
+        case OM_CYCSYNC_VELOCITY:
+        {
+            double target_rad_sec = output_->target_velocity * scales_.velocity_rad_sec;
+            double limited_rad_sec = std::max(min_velocity_rad_sec,
+                                              std::min(max_velocity_rad_sec, target_rad_sec));
+
+            if (limited_rad_sec != target_rad_sec)
+            {
+                // truncation rounds towards zero, i.e. into the permitted range
+                output_->target_velocity = limited_rad_sec / scales_.velocity_rad_sec;
+            }
+            break;
+        }
+        case OM_PROFILE_TORQUE:
+        case OM_CYCSYNC_TORQUE:
+        {
+            // a torque of zero would let the drive coast through the limit, so the velocity
+            // loop of the drive brakes it down to the permitted velocity. Restoring a torque
+            // towards the limit would accelerate the drive through it again, so the velocity
+            // loop holds the limit until the torque points away from it.
+            if (velocity_rad_sec > max_velocity_rad_sec)
+                braking_direction = 1;
+            else if (velocity_rad_sec < min_velocity_rad_sec)
+                braking_direction = -1;
+            else if (braking_direction_ * output_->target_torque > 0)
+                braking_direction = braking_direction_;
+
+            if (braking_direction != 0)
+            {
+                braking_operation_mode_ = output_->operation_mode;
+                braking_target_torque_ = output_->target_torque;
+                output_->target_velocity =
+                    (braking_direction > 0 ? max_velocity_rad_sec : min_velocity_rad_sec)
+                    / scales_.velocity_rad_sec;
+                output_->target_torque = 0;
+                output_->operation_mode = OM_CYCSYNC_VELOCITY;
+                braking_target_velocity_ = output_->target_velocity;
+            }
+            else if (velocity_rad_sec >= max_velocity_rad_sec && output_->target_torque > 0)
+                output_->target_torque = 0;
+            else if (velocity_rad_sec <= min_velocity_rad_sec && output_->target_torque < 0)
+                output_->target_torque = 0;
+            break;
+        }
+        default:
+            break;
+    }
+
+    braking_direction_ = braking_direction;
+}
+
+double CanDriveTwitter::getProfileAccelerationRadSecSec()
 {
-    std::unique_lock<std::mutex> lock(command_mutex_);
+    return params_.profile_acceleration_rad_sec_sec;
+}
 
-    double input_torque_nm = torque_nm / params_.gear_ratio;
-    output_->target_torque = input_torque_nm * 1000.0 / params_.motor_rated_torque_nm;
-    commandOperationMode(OM_PROFILE_TORQUE);
+int32_t CanDriveTwitter::toDrivePositionInc(double position_rad)
+{
+    return (int32_t)(uint32_t)llround(position_rad / scales_.position_rad);
 }
 
 bool CanDriveTwitter::checkTargetReached()
@@ -414,42 +733,60 @@ bool CanDriveTwitter::checkSetPointAcknowledge()
 
 double CanDriveTwitter::readPositionRad()
 {
-    double position_inc = input_->actual_position;
-    double position_rad =
-        position_inc * 2.0 * M_PI
-        / ((params_.encoder_on_output ? 1.0 : params_.gear_ratio) * params_.encoder_increments);
-
-    return position_rad;
+    return position_inc_.load(std::memory_order_relaxed) * scales_.position_rad;
 }
 
 double CanDriveTwitter::readVelocityRadSec()
 {
-    double velocity_inc = input_->actual_velocity;
-    double velocity_rad_sec =
-        velocity_inc * 2.0 * M_PI
-        / ((params_.encoder_on_output ? 1.0 : params_.gear_ratio) * params_.encoder_increments);
-
-    return velocity_rad_sec;
+    return velocity_inc_.load(std::memory_order_relaxed) * scales_.velocity_rad_sec;
 }
 
 double CanDriveTwitter::readTorqueNm()
 {
-    double input_torque_nm = input_->actual_torque * params_.motor_rated_torque_nm / 1000.0;
-    double output_torque_nm = input_torque_nm * params_.gear_ratio;
-
-    return output_torque_nm;
+    return torque_.load(std::memory_order_relaxed) * scales_.torque_nm;
 }
 
-double CanDriveTwitter::readAnalogInputV() { return input_->analog_input * 1.0 / 1000.0; }
+double CanDriveTwitter::readAnalogInputV()
+{
+    return analog_input_.load(std::memory_order_relaxed) * scales_.analog_input_v;
+}
 
 double CanDriveTwitter::readAuxiliaryPositionRad()
 {
-    return input_->auxiliary_position * 2.0 * M_PI / 4096.0;
+    return aux_position_inc_.load(std::memory_order_relaxed) * scales_.aux_position_rad;
+}
+
+double CanDriveTwitter::readAuxiliaryVelocityRadSec()
+{
+    return aux_velocity_rad_sec_.load(std::memory_order_relaxed);
+}
+
+void CanDriveTwitter::setAuxiliaryVelocityFilter(double alpha, double beta)
+{
+    aux_filter_alpha_ = alpha;
+    aux_filter_beta_ = beta;
 }
 
 CanDriveTwitter::DriveState CanDriveTwitter::readDriveState()
 {
-    unsigned char status_lower = (unsigned char)input_->status_word;
+    DriveState state = decodeDriveState(input_->status_word);
+
+    if (state == ST_UNKNOWN)
+    {
+        unsigned char status_lower = (unsigned char)input_->status_word;
+
+        ss << "Drive " << device_name_
+                   << " in unknown state! Lower byte of status word: " << status_lower;
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+    }
+
+    return state;
+}
+
+CanDriveTwitter::DriveState CanDriveTwitter::decodeDriveState(uint16_t status_word)
+{
+    unsigned char status_lower = (unsigned char)status_word;
     unsigned char bits0to3 = status_lower & 0x0f;
     unsigned char bit5 = (status_lower >> 5) & 0x01;
     unsigned char bit6 = (status_lower >> 6) & 0x01;
@@ -482,13 +819,11 @@ CanDriveTwitter::DriveState CanDriveTwitter::readDriveState()
             break;
     }
 
-    ss << "Drive " << device_name_
-               << " in unknown state! Lower byte of status word: " << status_lower;
-    log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
-    ss.str(""); ss.clear();
     return ST_UNKNOWN;
 }
 
+uint16_t CanDriveTwitter::readStatusWord() { return input_->status_word; }
+
 bool CanDriveTwitter::isError()
 {
     DriveState state = readDriveState();
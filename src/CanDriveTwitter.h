@@ -1,11 +1,14 @@
 #pragma once
 
-#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <map>
 #include <mutex>
-#include <thread>
+#include <vector>
 
 #include "CanDevice.h"
 #include "PlatformDriverEthercatTypes.h"
+#include "SpscQueue.h"
 
 namespace platform_driver_ethercat
 {
@@ -32,6 +35,8 @@ class CanDriveTwitter : public CanDevice
     bool configure();
     void setInputPdo(unsigned char* input_pdo);
     void setOutputPdo(unsigned char* output_pdo);
+    void update(const CycleInfo& cycle);
+    bool processMailbox();
 
     /**
      * Brings the drive to operation enable state.
@@ -56,6 +61,8 @@ class CanDriveTwitter : public CanDevice
 
     /**
      * Sends position command
+     * Commands never block, the process data cycle applies the latest one and performs the set
+     * point handshake with the drive.
      * @param position_rad Position command in Radians
      */
     void commandPositionRad(double position_rad);
@@ -75,7 +82,48 @@ class CanDriveTwitter : public CanDevice
     void commandTorqueNm(double torque_nm);
 
     /**
-     * Reads the last received value of the drive position.
+     * Writes a cyclic synchronous position set point.
+     * Does not wait for the drive, intended to be called once per process data cycle.
+     * @param position_rad Position set point in Radians
+     */
+    void writeCyclicPositionRad(double position_rad);
+
+    /**
+     * Writes a cyclic synchronous velocity set point.
+     * Does not wait for the drive, intended to be called once per process data cycle.
+     * @param velocity_rad_sec Velocity set point in Radians/sec.
+     */
+    void writeCyclicVelocityRadSec(double velocity_rad_sec);
+
+    /**
+     * Writes a cyclic synchronous torque set point.
+     * Does not wait for the drive, intended to be called once per process data cycle.
+     * @param torque_nm Torque set point in Nm.
+     */
+    void writeCyclicTorqueNm(double torque_nm);
+
+    /**
+     * Limits the velocity or torque set point that is sent in the current cycle.
+     * Velocity set points are clamped. Torque set points that would accelerate the drive beyond
+     * a velocity limit are zeroed. If the drive already exceeds a limit, the torque set point is
+     * replaced by the exceeded limit as cyclic synchronous velocity set point, so the drive
+     * brakes. The velocity set point holds the limit as long as the torque set point pushes
+     * towards it, the torque set point is restored once it points away from the limit.
+     * Position set points are not changed.
+     * Called from the process data cycle.
+     * @param min_velocity_rad_sec Lowest permitted velocity in Radians/sec.
+     * @param max_velocity_rad_sec Highest permitted velocity in Radians/sec.
+     */
+    void limitVelocityRadSec(double min_velocity_rad_sec, double max_velocity_rad_sec);
+
+    /**
+     * Returns the profile acceleration of the drive.
+     * @return The acceleration in Radians/sec^2.
+     */
+    double getProfileAccelerationRadSecSec();
+
+    /**
+     * Reads the last received value of the drive position, unwrapped to 64 bit.
      * @return The value of the current position of the motor in radians.
      */
     double readPositionRad();
@@ -99,11 +147,29 @@ class CanDriveTwitter : public CanDevice
     double readAnalogInputV();
 
     /**
-     * Returns the last received value from the auxiliary position.
+     * Returns the last received value from the auxiliary position, unwrapped over multiple turns.
      * Returns The auxiliary position value in radians.
      */
     double readAuxiliaryPositionRad();
 
+    /**
+     * Returns the auxiliary velocity estimated in the process data cycle.
+     * @return The auxiliary velocity in radians per second.
+     */
+    double readAuxiliaryVelocityRadSec();
+
+    /**
+     * Sets the gains of the alpha-beta tracker estimating the auxiliary velocity.
+     * @param alpha Position correction gain in [0, 1].
+     * @param beta Velocity correction gain in [0, 2].
+     */
+    void setAuxiliaryVelocityFilter(double alpha, double beta);
+
+    /**
+     * Returns the last received CiA402 status word.
+     */
+    uint16_t readStatusWord();
+
     /**
      * Returns true if an error has been detected.
      * @return boolean with result.
@@ -116,6 +182,18 @@ class CanDriveTwitter : public CanDevice
      */
     unsigned int getError();
 
+    /**
+     * Returns the faults captured since the interface was initialized.
+     * @param records Fault records, oldest first.
+     */
+    void readFaultRecords(std::vector<DriveFaultRecord>& records);
+
+    /**
+     * Registers DC link voltage, drive temperature and error code as telemetry.
+     * @return Telemetry identifiers by name.
+     */
+    std::map<std::string, int> addTelemetry();
+
     /**
      * Enable the emergency stop.
      * @return true if the result of the process is successful
@@ -221,6 +299,7 @@ class CanDriveTwitter : public CanDevice
 
         // Drive data objects
         ANALOG_INPUT = 0x2205,
+        TEMPERATURE = 0x22a3,
         DIGITAL_INPUTS = 0x60fd,
         DIGITAL_OUTPUTS = 0x60fe,
     };
@@ -275,22 +354,151 @@ class CanDriveTwitter : public CanDevice
         int32_t auxiliary_position;
     } TxPdo;
 
+    /**
+     * Conversion factors from the raw inputs to SI units.
+     */
+    struct DriveScales
+    {
+        double position_rad;      // rad per position increment
+        double velocity_rad_sec;  // rad/s per velocity increment
+        double torque_nm;         // Nm per unit of the actual torque
+        double aux_position_rad;  // rad per auxiliary encoder increment
+        double analog_input_v;    // V per unit of the analog input
+    };
+
+    // number of cycles recorded before a fault
+    static const unsigned int FAULT_HISTORY_LENGTH = 100;
+    // number of fault records kept for readout
+    static const size_t MAX_FAULT_RECORDS = 16;
+
+    /**
+     * Drive history captured by the process data cycle when a fault occurs.
+     */
+    struct FaultSnapshot
+    {
+        double time_sec;
+        uint16_t status_word;
+        unsigned int num_samples;
+        DriveSample history[FAULT_HISTORY_LENGTH];
+    };
+
     DriveParams params_;
 
     TxPdo* input_;
     RxPdo* output_;
 
-    std::thread command_thread_;
-    std::mutex command_mutex_;
-    std::condition_variable command_cv_;
+    int32_t aux_encoder_increments_;
+
+    // conversion factors of the inputs, also used inversely for the outputs
+    DriveScales scales_;
+
+    // position unwrapping and auxiliary velocity estimation, owned by the process data cycle
+    double aux_filter_alpha_;
+    double aux_filter_beta_;
+    bool inputs_initialized_;
+    int32_t last_position_inc_;
+    int32_t last_aux_position_inc_;
+    int64_t position_unwrapped_inc_;
+    int64_t aux_unwrapped_inc_;
+    double aux_last_time_sec_;
+    double aux_position_est_inc_;
+    double aux_velocity_est_inc_sec_;
+    std::atomic<double> aux_velocity_rad_sec_;
+
+    // raw inputs published by the process data cycle, converted when read
+    std::atomic<int64_t> position_inc_;
+    std::atomic<int32_t> velocity_inc_;
+    std::atomic<int16_t> torque_;
+    std::atomic<int64_t> aux_position_inc_;
+    std::atomic<int16_t> analog_input_;
+
+    // fault diagnostics, history owned by the process data cycle
+    DriveSample history_[FAULT_HISTORY_LENGTH];
+    unsigned int history_next_;
+    unsigned int history_size_;
+    bool in_fault_;
+    SpscQueue<FaultSnapshot, 4> fault_snapshots_;
+    std::mutex fault_records_mutex_;
+    std::deque<DriveFaultRecord> fault_records_;
+
+    /**
+     * Converts a position in radians to the 32 bit drive position.
+     * The unwrapped position is congruent to the drive position modulo 2^32, so truncating
+     * yields the target in the drive's frame.
+     */
+    int32_t toDrivePositionInc(double position_rad);
+
+    /**
+     * Instantaneous command, written by any thread and applied by the process data cycle.
+     */
+    struct Command
+    {
+        int32_t target;           // target position, velocity or torque in drive units
+        uint16_t sequence;        // changes with every command
+        uint16_t operation_mode;  // profile mode of the target
+    };
+
+    /**
+     * Steps of the set point handshake of the profile position mode.
+     */
+    enum SetPointState
+    {
+        SP_IDLE,
+        SP_WAIT_READY,  // waiting for the drive to clear the acknowledge of the last set point
+        SP_WAIT_ACK     // new set point raised, waiting for the acknowledge
+    };
+
+    // latest command, a newer command overwrites one that was not applied yet
+    std::atomic<uint16_t> command_sequence_;
+    std::atomic<Command> command_;
+
+    // command handshake, owned by the process data cycle
+    uint16_t applied_command_sequence_;
+    OperationMode command_mode_;
+    bool command_mode_pending_;
+    double command_time_sec_;
+    SetPointState set_point_state_;
+    double set_point_time_sec_;
+
+    // torque set point replaced by a velocity set point while the drive brakes down to a
+    // velocity limit, 1 for the upper and -1 for the lower limit, owned by the process data cycle
+    int8_t braking_direction_;
+    uint16_t braking_operation_mode_;
+    int16_t braking_target_torque_;
+    int32_t braking_target_velocity_;
+
+    /**
+     * Sends a command to the process data cycle without waiting.
+     */
+    void submitCommand(OperationMode mode, int32_t target);
+
+    /**
+     * Applies the latest command and advances the operation mode change and set point
+     * handshake. Called from the process data cycle.
+     */
+    void updateCommand(const CycleInfo& cycle);
 
     /**
      * Returns the state of the drive
      */
     DriveState readDriveState();
 
+    /**
+     * Decodes the drive state from the status word without logging.
+     */
+    static DriveState decodeDriveState(uint16_t status_word);
+
+    /**
+     * Publishes the unwrapped positions and the other inputs of the cycle to the readers.
+     */
+    void storeInputs();
+
+    /**
+     * Records the drive history and captures it on a transition into a fault state.
+     */
+    void updateDiagnostics(const CycleInfo& cycle);
+
     OperationMode readOperationMode();
-    bool commandOperationMode(OperationMode mode);
 
     /**
      * Checks if the target set point was already reached.
@@ -304,7 +512,5 @@ class CanDriveTwitter : public CanDevice
      * @return True if the new set point was acknowledged.
      */
     bool checkSetPointAcknowledge();
-
-    void commandSetPoint();
 };
 }
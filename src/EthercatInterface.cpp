@@ -1,4 +1,16 @@
-//#include <chrono>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
 
 #include "CanDevice.h"
 #include "EthercatInterface.h"
@@ -11,17 +23,69 @@ static char cbuf[1024];
 using namespace platform_driver_ethercat;
 
 const int EC_TIMEOUTMON = 500;
+const double DEFAULT_CYCLE_PERIOD_SEC = 0.005;  // roughly 200 Hz
+const int BARRIER_SPINS = 1000;  // polls of the worker barrier before the cycle thread sleeps
+
+namespace
+{
+void addPhaseSample(CyclePhase& phase, double duration_sec)
+{
+    phase.samples++;
+    phase.last_sec = duration_sec;
+    phase.mean_sec += (duration_sec - phase.mean_sec) / phase.samples;
+    phase.max_sec = std::max(phase.max_sec, duration_sec);
+}
+
+/**
+ * Hints the CPU that the thread is spinning, which frees resources for the sibling hardware
+ * thread and saves power.
+ */
+inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+}
 
 int EthercatInterface::expected_wkc_ = 0;
 volatile int EthercatInterface::wkc_ = 0;
 
 EthercatInterface::EthercatInterface(const std::string interface_address,
                                      const unsigned int num_slaves)
-    : interface_address_(interface_address), num_slaves_(num_slaves), is_initialized_(false)
+    : interface_address_(interface_address),
+      num_slaves_(num_slaves),
+      is_initialized_(false),
+      has_dc_(false),
+      running_(false),
+      cycle_sequence_(0),
+      mailbox_period_(1),
+      cycle_futex_(0),
+      cycle_waiters_(0),
+      cycle_event_fd_(-1),
+      cycle_event_period_(1),
+      work_futex_(0),
+      work_pending_(0),
+      barrier_waiting_(false),
+      work_cycle_(NULL),
+      cycle_period_sec_(DEFAULT_CYCLE_PERIOD_SEC),
+      pipelined_cycle_(false),
+      early_outputs_(false),
+      phase_stats_()
 {
 }
 
-EthercatInterface::~EthercatInterface() { close(); }
+EthercatInterface::~EthercatInterface()
+{
+    close();
+
+    if (cycle_event_fd_ >= 0)
+    {
+        ::close(cycle_event_fd_);
+    }
+}
 
 bool EthercatInterface::init()
 {
@@ -83,7 +147,7 @@ bool EthercatInterface::init()
             /* configure all devices via sdo */
             for (auto& device : devices_)
             {
-                unsigned int slave_id = device.first;
+                unsigned int slave_id = device->getSlaveId();
 
                 if (slave_id > (unsigned int) ec_slavecount)
                 {
@@ -98,7 +162,7 @@ bool EthercatInterface::init()
                     return false;
                 }
 
-                device.second->configure();
+                device->configure();
             }
 
             // Disable complete access
@@ -110,15 +174,15 @@ bool EthercatInterface::init()
             }
 
             ec_config_map(&io_map_);
-            ec_configdc();
+            has_dc_ = ec_configdc();
 
             /* set pointers to pdo map for all devices */
             for (auto& device : devices_)
             {
-                unsigned int slave_id = device.first;
+                unsigned int slave_id = device->getSlaveId();
 
-                device.second->setInputPdo(ec_slave[slave_id].inputs);
-                device.second->setOutputPdo(ec_slave[slave_id].outputs);
+                device->setInputPdo(ec_slave[slave_id].inputs);
+                device->setOutputPdo(ec_slave[slave_id].outputs);
             }
 
             ss << "Slaves mapped, state to SAFE_OP";
@@ -158,7 +222,10 @@ bool EthercatInterface::init()
 
                 /* create thread for pdo cycle */
                 // pthread_create(&_thread_handle, NULL, &pdoCycle, NULL);
+                running_.store(true);
+                startWorkers();
                 ethercat_thread_ = std::thread(&EthercatInterface::pdoCycle, this);
+                mailbox_thread_ = std::thread(&EthercatInterface::mailboxCycle, this);
 
                 is_initialized_ = true;
 
@@ -230,6 +297,10 @@ void EthercatInterface::close()
 {
     if (isInit())
     {
+        // the cycle would take the dropping working counter for lost slaves and try to recover
+        // them, so it stops before the state changes
+        stopThreads();
+
         ss << "Request init state for all slaves";
         log(LogLevel::INFO, __PRETTY_FUNCTION__, ss.str());
         ss.str(""); ss.clear();
@@ -237,10 +308,6 @@ void EthercatInterface::close()
         /* request INIT state for all slaves */
         ec_writestate(0);
 
-        // cancel pdo_cycle thread
-        // pthread_cancel(_thread_handle);
-        // pthread_join(_thread_handle, NULL);
-
         is_initialized_ = false;
     }
 
@@ -263,17 +330,93 @@ bool EthercatInterface::addDevice(std::shared_ptr<CanDevice> device)
         return false;
     }
 
-    devices_.insert(std::make_pair(device->getSlaveId(), device));
+    unsigned int slave_id = device->getSlaveId();
+
+    auto position = std::lower_bound(devices_.begin(),
+                                     devices_.end(),
+                                     slave_id,
+                                     [](const std::shared_ptr<CanDevice>& other, unsigned int id)
+                                     { return other->getSlaveId() < id; });
+
+    if (position != devices_.end() && (*position)->getSlaveId() == slave_id)
+    {
+        ss << "Slave id " << slave_id << " is already used by another device";
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    devices_.insert(position, device);
+
+    return true;
+}
+
+bool EthercatInterface::addCycleCallback(std::function<void(const CycleInfo&)> callback)
+{
+    if (isInit())
+    {
+        ss << "EtherCAT interface already initialized, cycle callback cannot be added afterwards";
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    cycle_callbacks_.push_back(std::move(callback));
 
     return true;
 }
 
+int EthercatInterface::addTelemetry(uint16_t slave,
+                                    uint16_t idx,
+                                    uint8_t sub,
+                                    TelemetryType type,
+                                    double scale)
+{
+    if (isInit())
+    {
+        ss << "EtherCAT interface already initialized, telemetry cannot be added afterwards";
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return -1;
+    }
+
+    telemetry_.emplace_back();
+
+    Telemetry& telemetry = telemetry_.back();
+    telemetry.slave = slave;
+    telemetry.idx = idx;
+    telemetry.sub = sub;
+    telemetry.type = type;
+    telemetry.scale = scale;
+    telemetry.value.write(TelemetryValue{0.0, 0.0, false});
+
+    return telemetry_.size() - 1;
+}
+
+TelemetryValue EthercatInterface::readTelemetry(int telemetry_id)
+{
+    return telemetry_.at(telemetry_id).value.read();
+}
+
+void EthercatInterface::setMailboxPeriod(unsigned int cycles)
+{
+    mailbox_period_.store(std::max(cycles, 1u));
+}
+
+double EthercatInterface::getTimeSec()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 bool EthercatInterface::sdoRead(uint16_t slave, uint16_t idx, uint8_t sub, int* data)
 {
     int fieldsize = sizeof(data);
 
     int wkc = ec_SDOread(slave, idx, sub, FALSE, &fieldsize, data, EC_TIMEOUTTXM);
-    snprintf(cbuf, sizeof(cbuf), "%s: Read from slave %d at 0x%04x:%d => wkc: %d; data: 0x%.*x (%d)",
+
+    char message[256];
+    snprintf(message, sizeof(message), "%s: Read from slave %d at 0x%04x:%d => wkc: %d; data: 0x%.*x (%d)",
               __PRETTY_FUNCTION__,
               slave,
               idx,
@@ -282,7 +425,7 @@ bool EthercatInterface::sdoRead(uint16_t slave, uint16_t idx, uint8_t sub, int*
               2 * fieldsize,
               *data,
               *data);
-    log(LogLevel::DEBUG, __PRETTY_FUNCTION__, cbuf);
+    log(LogLevel::DEBUG, __PRETTY_FUNCTION__, message);
 
     if (wkc == 1)
         return true;
@@ -293,7 +436,9 @@ bool EthercatInterface::sdoRead(uint16_t slave, uint16_t idx, uint8_t sub, int*
 bool EthercatInterface::sdoWrite(uint16_t slave, uint16_t idx, uint8_t sub, int fieldsize, int data)
 {
     int wkc = ec_SDOwrite(slave, idx, sub, FALSE, fieldsize, &data, EC_TIMEOUTRXM);
-    snprintf(cbuf, sizeof(cbuf), "%s: Write to slave %d at 0x%04x:%d => wkc: %d; data: 0x%.*x (%d)",
+
+    char message[256];
+    snprintf(message, sizeof(message), "%s: Write to slave %d at 0x%04x:%d => wkc: %d; data: 0x%.*x (%d)",
               __PRETTY_FUNCTION__,
               slave,
               idx,
@@ -302,7 +447,7 @@ bool EthercatInterface::sdoWrite(uint16_t slave, uint16_t idx, uint8_t sub, int
               3 * fieldsize,
               data,
               data);
-    log(LogLevel::DEBUG, __PRETTY_FUNCTION__, cbuf);
+    log(LogLevel::DEBUG, __PRETTY_FUNCTION__, message);
 
     if (wkc == 1)
         return true;
@@ -320,12 +465,83 @@ unsigned char* EthercatInterface::getOutputPdoPtr(uint16_t slave)
 void EthercatInterface::pdoCycle()
 {
     int currentgroup = 0;
+    CycleInfo cycle_info{0, 0.0, 0.0, 0.0, 0, 0, 0};
+    double send_time_sec = 0.0;
+    double last_start_sec = 0.0;
+    double deadline_sec = getTimeSec();
+    bool early_outputs_sent = false;
 
-    while (1)
+    if (pipelined_cycle_)
     {
-        ec_send_processdata();
+        // primes the pipeline, later frames are sent as soon as their inputs were processed
+        send_time_sec = sendProcessData(0.0);
+    }
+
+    while (running_.load(std::memory_order_acquire))
+    {
+        double start_sec = getTimeSec();
+
+        if (early_outputs_sent)
+        {
+            // the outputs went out with the frame sent after the callbacks, whose inputs are
+            // as old as the last cycle
+            ec_receive_processdata(EC_TIMEOUTRET);
+            send_time_sec = sendProcessData(0.0);
+            early_outputs_sent = false;
+        }
+        else if (!pipelined_cycle_)
+        {
+            send_time_sec = sendProcessData(cycle_info.sample_time_sec);
+        }
+
+        double receive_start_sec = getTimeSec();
         wkc_ = ec_receive_processdata(EC_TIMEOUTRET);
 
+        cycle_info.sequence++;
+        cycle_info.time_sec = getTimeSec();
+        cycle_info.send_time_sec = send_time_sec;
+        cycle_info.wkc = wkc_;
+        cycle_info.expected_wkc = expected_wkc_;
+        cycle_info.dc_time_ns = has_dc_ ? ec_DCtime : 0;
+
+        // the slaves latch the inputs while the frame passes, about halfway through the round
+        // trip, a pipelined frame returned long before it is collected
+        cycle_info.sample_time_sec =
+            pipelined_cycle_ ? send_time_sec : 0.5 * (send_time_sec + cycle_info.time_sec);
+
+        updateDevices(cycle_info);
+
+        for (auto& callback : cycle_callbacks_)
+        {
+            callback(cycle_info);
+        }
+
+        double process_end_sec = getTimeSec();
+
+        if (pipelined_cycle_)
+        {
+            send_time_sec = sendProcessData(cycle_info.sample_time_sec);
+        }
+        else if (early_outputs_)
+        {
+            sendProcessData(cycle_info.sample_time_sec);
+            early_outputs_sent = true;
+        }
+
+        phase_stats_.cycles++;
+        addPhaseSample(phase_stats_.receive, cycle_info.time_sec - receive_start_sec);
+        addPhaseSample(phase_stats_.process, process_end_sec - cycle_info.time_sec);
+        if (last_start_sec > 0.0)
+        {
+            addPhaseSample(phase_stats_.period, start_sec - last_start_sec);
+        }
+        last_start_sec = start_sec;
+
+        cycle_sequence_.store(cycle_info.sequence);
+        mailbox_cv_.notify_one();
+
+        notifyCycle(cycle_info);
+
         while (EcatError) printf("%s", ec_elist2string());
 
         if ((wkc_ < expected_wkc_) || ec_group[currentgroup].docheckstate)
@@ -414,9 +630,373 @@ void EthercatInterface::pdoCycle()
             }
         }
 
-        //osal_usleep(1000);  // roughly 1000 Hz
-        osal_usleep(5000);  // roughly 200 Hz
-        //osal_usleep(10000);  // roughly 100 Hz
+        if (pipelined_cycle_)
+        {
+            deadline_sec += cycle_period_sec_;
+
+            // skips missed deadlines instead of catching up with a burst of frames
+            if (getTimeSec() > deadline_sec)
+            {
+                phase_stats_.overruns++;
+                deadline_sec = getTimeSec();
+            }
+        }
+
+        published_phase_stats_.write(phase_stats_);
+
+        if (pipelined_cycle_)
+        {
+            timespec deadline;
+            deadline.tv_sec = static_cast<time_t>(deadline_sec);
+            deadline.tv_nsec = static_cast<long>((deadline_sec - deadline.tv_sec) * 1e9);
+
+            // the clock of getTimeSec, the sleep is restarted if a signal interrupts it
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR)
+            {
+            }
+        }
+        else
+        {
+            osal_usleep(static_cast<uint32_t>(cycle_period_sec_ * 1e6));
+        }
         //LOG_DEBUG_S << __PRETTY_FUNCTION__ << "" << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count(); 
     }
 }
+
+double EthercatInterface::sendProcessData(double inputs_time_sec)
+{
+    double start_sec = getTimeSec();
+    ec_send_processdata();
+    double end_sec = getTimeSec();
+
+    addPhaseSample(phase_stats_.send, end_sec - start_sec);
+
+    if (inputs_time_sec > 0.0)
+    {
+        addPhaseSample(phase_stats_.latency, end_sec - inputs_time_sec);
+    }
+
+    return start_sec;
+}
+
+void EthercatInterface::notifyCycle(const CycleInfo& cycle)
+{
+    // sequentially consistent, so either the waiter sees the new cycle or the cycle sees the
+    // waiter, release and acquire alone allow both to read the old values
+    cycle_futex_.fetch_add(1, std::memory_order_seq_cst);
+
+    if (cycle_waiters_.load(std::memory_order_seq_cst) > 0)
+    {
+        syscall(SYS_futex, &cycle_futex_, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+    }
+
+    if (cycle_event_fd_ >= 0 && cycle.sequence % cycle_event_period_ == 0)
+    {
+        uint64_t count = 1;
+
+        // fails only if the counter saturates because nobody reads, the event is dropped then
+        ssize_t result = write(cycle_event_fd_, &count, sizeof(count));
+        (void)result;
+    }
+}
+
+bool EthercatInterface::waitForNextCycle(double timeout_sec)
+{
+    uint32_t cycle = cycle_futex_.load(std::memory_order_acquire);
+    double deadline_sec = getTimeSec() + timeout_sec;
+
+    cycle_waiters_.fetch_add(1, std::memory_order_seq_cst);
+
+    // the futex returns immediately if the word changed after it was loaded
+    while (cycle_futex_.load(std::memory_order_seq_cst) == cycle)
+    {
+        double remaining_sec = deadline_sec - getTimeSec();
+
+        if (remaining_sec <= 0.0) break;
+
+        struct timespec timeout;
+        timeout.tv_sec = (time_t)remaining_sec;
+        timeout.tv_nsec = (long)((remaining_sec - timeout.tv_sec) * 1e9);
+
+        syscall(SYS_futex, &cycle_futex_, FUTEX_WAIT_PRIVATE, cycle, &timeout, NULL, 0);
+    }
+
+    cycle_waiters_.fetch_sub(1, std::memory_order_acq_rel);
+
+    return cycle_futex_.load(std::memory_order_acquire) != cycle;
+}
+
+int EthercatInterface::enableCycleEvents(unsigned int cycles)
+{
+    if (isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return -1;
+    }
+
+    if (cycle_event_fd_ < 0)
+    {
+        cycle_event_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        if (cycle_event_fd_ < 0)
+        {
+            ss << "Cannot create eventfd: " << strerror(errno);
+            log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+            ss.str(""); ss.clear();
+            return -1;
+        }
+    }
+
+    cycle_event_period_ = std::max(1u, cycles);
+
+    return cycle_event_fd_;
+}
+
+bool EthercatInterface::enableWorkers(std::vector<int> cpus)
+{
+    if (isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    worker_cpus_ = cpus;
+
+    return true;
+}
+
+bool EthercatInterface::setCyclePeriod(double period_sec)
+{
+    if (isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    if (!(period_sec > 0.0) || !std::isfinite(period_sec))
+    {
+        ss << "Invalid cycle period " << period_sec;
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    cycle_period_sec_ = period_sec;
+
+    return true;
+}
+
+bool EthercatInterface::enablePipelinedCycle()
+{
+    if (isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    pipelined_cycle_ = true;
+
+    return true;
+}
+
+bool EthercatInterface::enableEarlyOutputs()
+{
+    if (isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    early_outputs_ = true;
+
+    return true;
+}
+
+CyclePhaseStats EthercatInterface::readCyclePhaseStats() { return published_phase_stats_.read(); }
+
+void EthercatInterface::startWorkers()
+{
+    partitions_.assign(worker_cpus_.size() + 1, std::vector<CanDevice*>());
+
+    for (size_t i = 0; i < devices_.size(); i++)
+    {
+        partitions_[i % partitions_.size()].push_back(devices_[i].get());
+    }
+
+    for (size_t i = 0; i < worker_cpus_.size(); i++)
+    {
+        worker_threads_.push_back(std::thread(&EthercatInterface::workerCycle, this, i + 1));
+
+        if (worker_cpus_[i] < 0) continue;
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(worker_cpus_[i], &cpu_set);
+
+        if (pthread_setaffinity_np(
+                worker_threads_.back().native_handle(), sizeof(cpu_set), &cpu_set) != 0)
+        {
+            ss << "Could not pin worker " << i << " to CPU " << worker_cpus_[i];
+            log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str());
+            ss.str(""); ss.clear();
+        }
+    }
+}
+
+void EthercatInterface::stopThreads()
+{
+    {
+        // under the lock, so the mailbox thread cannot miss the notification before it waits
+        std::lock_guard<std::mutex> lock(mailbox_mutex_);
+        running_.store(false);
+    }
+
+    mailbox_cv_.notify_all();
+
+    if (ethercat_thread_.joinable()) ethercat_thread_.join();
+    if (mailbox_thread_.joinable()) mailbox_thread_.join();
+
+    // the cycle thread has stopped, so the workers wake up without work and return
+    work_futex_.fetch_add(1, std::memory_order_seq_cst);
+    syscall(SYS_futex, &work_futex_, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+
+    for (auto& worker : worker_threads_)
+    {
+        worker.join();
+    }
+
+    worker_threads_.clear();
+}
+
+void EthercatInterface::updateDevices(const CycleInfo& cycle)
+{
+    if (worker_threads_.empty())
+    {
+        updatePartition(partitions_[0], cycle);
+        return;
+    }
+
+    work_cycle_ = &cycle;
+    work_pending_.store(worker_threads_.size(), std::memory_order_relaxed);
+    work_futex_.fetch_add(1, std::memory_order_release);
+    syscall(SYS_futex, &work_futex_, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+
+    updatePartition(partitions_[0], cycle);
+
+    // the partitions are small, so the barrier spins for a while before it sleeps
+    for (int spin = 0; work_pending_.load(std::memory_order_acquire) > 0; spin++)
+    {
+        if (spin < BARRIER_SPINS)
+        {
+            cpuRelax();
+            continue;
+        }
+
+        // sequentially consistent, so either the last worker sees the waiting cycle thread or
+        // the cycle thread sees the finished count, like in notifyCycle
+        barrier_waiting_.store(true, std::memory_order_seq_cst);
+        int pending = work_pending_.load(std::memory_order_seq_cst);
+
+        // the futex returns immediately if a worker finished after the load
+        if (pending > 0)
+        {
+            syscall(SYS_futex, &work_pending_, FUTEX_WAIT_PRIVATE, pending, NULL, NULL, 0);
+        }
+    }
+
+    barrier_waiting_.store(false, std::memory_order_relaxed);
+}
+
+void EthercatInterface::updatePartition(const std::vector<CanDevice*>& partition,
+                                        const CycleInfo& cycle)
+{
+    for (CanDevice* device : partition)
+    {
+        device->update(cycle);
+    }
+}
+
+void EthercatInterface::workerCycle(size_t partition)
+{
+    uint32_t work = 0;
+
+    while (1)
+    {
+        // the futex returns immediately if work was handed over after the load
+        while (work_futex_.load(std::memory_order_acquire) == work)
+        {
+            syscall(SYS_futex, &work_futex_, FUTEX_WAIT_PRIVATE, work, NULL, NULL, 0);
+        }
+
+        work = work_futex_.load(std::memory_order_acquire);
+
+        if (!running_.load(std::memory_order_acquire)) return;
+
+        updatePartition(partitions_[partition], *work_cycle_);
+
+        // the last worker wakes the cycle thread if it stopped spinning
+        if (work_pending_.fetch_sub(1, std::memory_order_seq_cst) == 1
+            && barrier_waiting_.load(std::memory_order_seq_cst))
+        {
+            syscall(SYS_futex, &work_pending_, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+        }
+    }
+}
+
+void EthercatInterface::mailboxCycle()
+{
+    uint64_t last_sequence = 0;
+    auto next_device = devices_.begin();
+    size_t next_telemetry = 0;
+
+    while (running_.load(std::memory_order_acquire))
+    {
+        {
+            std::unique_lock<std::mutex> lock(mailbox_mutex_);
+            mailbox_cv_.wait_for(lock, std::chrono::milliseconds(100), [&] {
+                return cycle_sequence_.load() - last_sequence >= mailbox_period_.load()
+                       || !running_.load();
+            });
+            last_sequence = cycle_sequence_.load();
+        }
+
+        if (!running_.load(std::memory_order_acquire)) break;
+
+        // requests of the devices take precedence, visit them round-robin until one of them
+        // performed a transaction
+        bool done = false;
+
+        for (size_t i = 0; i < devices_.size() && !done; i++)
+        {
+            if (next_device == devices_.end()) next_device = devices_.begin();
+
+            done = (*next_device++)->processMailbox();
+        }
+
+        if (!done && !telemetry_.empty())
+        {
+            readTelemetryObject(telemetry_[next_telemetry]);
+            next_telemetry = (next_telemetry + 1) % telemetry_.size();
+        }
+    }
+}
+
+void EthercatInterface::readTelemetryObject(Telemetry& telemetry)
+{
+    int data = 0;
+
+    if (!sdoRead(telemetry.slave, telemetry.idx, telemetry.sub, &data)) return;
+
+    double raw;
+
+    switch (telemetry.type)
+    {
+        case TelemetryType::INT16: raw = (int16_t)data; break;
+        case TelemetryType::UINT16: raw = (uint16_t)data; break;
+        case TelemetryType::INT32: raw = (int32_t)data; break;
+        case TelemetryType::UINT32: raw = (uint32_t)data; break;
+        default: raw = data; break;
+    }
+
+    telemetry.value.write(TelemetryValue{raw * telemetry.scale, getTimeSec(), true});
+}
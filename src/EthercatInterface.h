@@ -1,15 +1,45 @@
 #pragma once
 
-#include <map>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
+
+#include "PlatformDriverEthercatTypes.h"
+#include "SeqLock.h"
 
 namespace platform_driver_ethercat
 {
 
 class CanDevice;
 
+/**
+ * Information about the process data cycle passed to cycle callbacks.
+ * In the pipelined cycle the frame is collected a period after it was sent, so time_sec is the
+ * collection time, use sample_time_sec for the time of the inputs.
+ */
+struct CycleInfo
+{
+    uint64_t sequence;       // number of cycles since the interface was initialized
+    double time_sec;         // monotonic time at which the process data was received
+    double send_time_sec;    // monotonic time at which the received frame was sent
+    double sample_time_sec;  // estimated monotonic time at which the slaves latched the inputs
+    int wkc;                 // working counter of the received frame
+    int expected_wkc;        // working counter of a frame that all slaves processed
+    int64_t dc_time_ns;      // distributed clock time of the frame, 0 if no slave supports it
+
+    CycleStamp getStamp() const
+    {
+        return CycleStamp{sequence, time_sec, wkc >= expected_wkc, dc_time_ns};
+    }
+};
+
 class EthercatInterface
 {
   public:
@@ -18,24 +48,199 @@ class EthercatInterface
     bool init();
     void close();
     bool isInit();
+
+    /**
+     * Adds a device that is updated in every cycle, a second device for a slave id is rejected.
+     */
     bool addDevice(std::shared_ptr<CanDevice> device);
+
+    /**
+     * Adds a callback that is executed in the process data cycle after new inputs were received.
+     * Callbacks can only be added before the interface is initialized.
+     */
+    bool addCycleCallback(std::function<void(const CycleInfo&)> callback);
+
+    /**
+     * Blocks until the process data cycle has processed the next frame.
+     * @param timeout_sec Maximum time to wait.
+     * @return False on timeout.
+     */
+    bool waitForNextCycle(double timeout_sec);
+
+    /**
+     * Creates an eventfd that is signaled every given number of cycles.
+     * Can only be enabled before the interface is initialized.
+     * @return File descriptor of the eventfd, -1 on failure.
+     */
+    int enableCycleEvents(unsigned int cycles);
+
+    /**
+     * Updates the devices on worker threads in parallel with the process data cycle.
+     * The devices of each type are split round-robin between the cycle thread and the workers,
+     * which meet at a barrier before the cycle callbacks run.
+     * Can only be enabled before the interface is initialized.
+     * @param cpus CPU to pin each worker to, negative values leave a worker unpinned.
+     */
+    bool enableWorkers(std::vector<int> cpus);
+
+    /**
+     * Sets the period of the process data cycle, 5 ms by default. The default cycle sleeps this
+     * long after every cycle, the pipelined cycle wakes up at deadlines this far apart.
+     * Can only be set before the interface is initialized.
+     */
+    bool setCyclePeriod(double period_sec);
+
+    /**
+     * Reorders the process data cycle to receive the frame sent in the last cycle, process it,
+     * send the outputs immediately and sleep until the next absolute deadline. The frame travels
+     * while the cycle sleeps, so the cycle thread does not wait for the round trip and the
+     * period does not drift with the processing time. The input to output latency stays about
+     * one period, as the inputs were latched when the frame passed the slaves, a period before
+     * they are processed. Can only be enabled before the interface is initialized.
+     */
+    bool enablePipelinedCycle();
+
+    /**
+     * Sends an additional frame with the outputs right after the cycle callbacks, so that set
+     * points computed from the received inputs reach the slaves within the same cycle instead
+     * of with the frame of the next cycle. That frame is collected at the start of the next
+     * cycle, which then exchanges a fresh frame as usual. Doubles the frames of the default
+     * cycle, the pipelined cycle already sends right after the callbacks. Can only be enabled
+     * before the interface is initialized.
+     */
+    bool enableEarlyOutputs();
+
+    /**
+     * Returns the timing of the phases of the process data cycle.
+     */
+    CyclePhaseStats readCyclePhaseStats();
+
+    /**
+     * Adds an object that is read periodically over the mailbox and cached.
+     * Telemetry can only be added before the interface is initialized.
+     * @param scale Factor applied to the raw value.
+     * @return Identifier of the telemetry, -1 if it could not be added.
+     */
+    int addTelemetry(uint16_t slave, uint16_t idx, uint8_t sub, TelemetryType type, double scale);
+
+    /**
+     * Returns the cached value of a telemetry object without accessing the bus.
+     */
+    TelemetryValue readTelemetry(int telemetry_id);
+
+    /**
+     * Limits the mailbox traffic to one transaction every given number of cycles.
+     */
+    void setMailboxPeriod(unsigned int cycles);
     unsigned char* getInputPdoPtr(uint16_t slave);
     unsigned char* getOutputPdoPtr(uint16_t slave);
 
     static bool sdoRead(uint16_t slave, uint16_t idx, uint8_t sub, int* data);
     static bool sdoWrite(uint16_t slave, uint16_t idx, uint8_t sub, int fieldsize, int data);
 
+    /**
+     * Returns the monotonic time used to time stamp the process data cycle.
+     */
+    static double getTimeSec();
+
   private:
     const std::string interface_address_;
     const unsigned int num_slaves_;
     char io_map_[4096];
     bool is_initialized_;
-    std::map<unsigned int, std::shared_ptr<CanDevice>> devices_;
+    bool has_dc_;
+    std::vector<std::shared_ptr<CanDevice>> devices_;  // ordered by slave id
+
+    std::vector<std::function<void(const CycleInfo&)>> cycle_callbacks_;
     std::thread ethercat_thread_;
+    std::atomic<bool> running_;  // cleared to stop the cycle, mailbox and worker threads
+
+    std::atomic<uint64_t> cycle_sequence_;
+    std::thread mailbox_thread_;
+    std::mutex mailbox_mutex_;
+    std::condition_variable mailbox_cv_;
+    std::atomic<unsigned int> mailbox_period_;
+
+    // futex word counting cycles, waiters are only woken if there are any
+    std::atomic<uint32_t> cycle_futex_;
+    std::atomic<int> cycle_waiters_;
+    int cycle_event_fd_;
+    unsigned int cycle_event_period_;
+
+    // device partitions, the first one is updated by the cycle thread itself
+    std::vector<int> worker_cpus_;
+    std::vector<std::vector<CanDevice*>> partitions_;
+    std::vector<std::thread> worker_threads_;
+    std::atomic<uint32_t> work_futex_;   // counts the cycles handed to the workers
+    std::atomic<int> work_pending_;      // workers that did not finish the current cycle
+    std::atomic<bool> barrier_waiting_;  // the cycle thread sleeps until the workers finished
+    const CycleInfo* work_cycle_;
+
+    double cycle_period_sec_;
+    bool pipelined_cycle_;
+    bool early_outputs_;
+    CyclePhaseStats phase_stats_;  // owned by the process data cycle
+    SeqLock<CyclePhaseStats> published_phase_stats_;
+
+    struct Telemetry
+    {
+        uint16_t slave;
+        uint16_t idx;
+        uint8_t sub;
+        TelemetryType type;
+        double scale;
+        SeqLock<TelemetryValue> value;
+    };
+
+    std::deque<Telemetry> telemetry_;
 
     static int expected_wkc_;
     static volatile int wkc_;
 
     void pdoCycle();
+
+    /**
+     * Sends the outputs and records the send duration and the input to output latency.
+     * @param inputs_time_sec Time at which the slaves latched the inputs the outputs were
+     * computed from, 0 if there are none yet.
+     * @return Time at which sending started.
+     */
+    double sendProcessData(double inputs_time_sec);
+
+    /**
+     * Splits the devices between the cycle thread and the workers and starts the workers.
+     */
+    void startWorkers();
+
+    /**
+     * Stops and joins the cycle, mailbox and worker threads, so init can start them again.
+     */
+    void stopThreads();
+
+    /**
+     * Updates the devices of all partitions, in parallel if workers are enabled.
+     */
+    void updateDevices(const CycleInfo& cycle);
+
+    static void updatePartition(const std::vector<CanDevice*>& partition,
+                                const CycleInfo& cycle);
+
+    void workerCycle(size_t partition);
+
+    /**
+     * Wakes the threads waiting for the cycle and signals the cycle eventfd.
+     */
+    void notifyCycle(const CycleInfo& cycle);
+
+    /**
+     * Performs pending mailbox transactions of the devices outside of the process data cycle,
+     * at most one per cycle.
+     */
+    void mailboxCycle();
+
+    /**
+     * Reads a telemetry object and updates its cached value.
+     */
+    void readTelemetryObject(Telemetry& telemetry);
 };
 }
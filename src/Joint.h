@@ -24,8 +24,8 @@ class Joint
     virtual bool readTorqueNm(double& torque_nm) = 0;
     virtual bool readTempDegC(double& temp_deg_c) = 0;
 
-    std::string getName() { return name_; };
-    std::shared_ptr<CanDriveTwitter> getDrive() { return drive_; };
+    const std::string& getName() const { return name_; };
+    const std::shared_ptr<CanDriveTwitter>& getDrive() const { return drive_; };
     bool isEnabled() { return enabled_; };
 
   protected:
@@ -1,9 +1,11 @@
 #include <algorithm>
+#include <cmath>
 #include <limits>
 
 #include "CanDriveTwitter.h"
 #include "JointActive.h"
 #include "Logging.hpp"
+#include "Trajectory.h"
 #include <sstream>
 static std::stringstream ss;
 
@@ -13,12 +15,37 @@ JointActive::JointActive(std::string name,
                          std::shared_ptr<CanDriveTwitter>& drive,
                          ActiveJointParams params,
                          bool enabled)
-    : Joint(name, drive, enabled), params_(params) {}
+    : Joint(name, drive, enabled),
+      params_(params),
+      pending_trajectory_(NULL),
+      active_trajectory_(NULL),
+      num_taken_trajectories_(0),
+      cancel_trajectory_(false),
+      release_group_(false),
+      num_handed_over_trajectories_(0),
+      has_set_point_(false),
+      last_set_point_rad_(0.0),
+      last_set_point_time_sec_(0.0),
+      position_limit_exceeded_(false),
+      velocity_limit_exceeded_(false),
+      position_limit_reached_(false),
+      torque_limit_exceeded_(false)
+{
+}
+
+JointActive::~JointActive()
+{
+    deleteRetiredTrajectories();
+    delete pending_trajectory_.load();
+    delete active_trajectory_.load();
+}
 
 bool JointActive::commandPositionRad(double position_rad)
 {
     if (!enabled_) return false;
 
+    cancelCyclicCommands();
+
     double position_old = position_rad;
 
     double min_pos = params_.min_position_command_rad;
@@ -29,12 +56,10 @@ bool JointActive::commandPositionRad(double position_rad)
         position_rad = std::max(min_pos, std::min(max_pos, position_rad));
     }
 
-    if (position_rad != position_old)
-    {
-        ss << ": Command exceeds position limit for joint " << name_;
-        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str().c_str());
-        ss.str(""); ss.clear();
-    }
+    warnLimit(__PRETTY_FUNCTION__,
+              ": Command exceeds position limit for joint ",
+              position_rad != position_old,
+              position_limit_exceeded_);
 
     if (params_.flip_sign)
     {
@@ -50,6 +75,8 @@ bool JointActive::commandVelocityRadSec(double velocity_rad_sec)
 {
     if (!enabled_) return false;
 
+    cancelCyclicCommands();
+
     double velocity_old = velocity_rad_sec;
     double max_vel = params_.max_velocity_command_rad_sec;
 
@@ -58,12 +85,10 @@ bool JointActive::commandVelocityRadSec(double velocity_rad_sec)
         velocity_rad_sec = std::min(max_vel, std::max(-max_vel, velocity_rad_sec));
     }
 
-    if (velocity_rad_sec != velocity_old)
-    {
-        ss << ": Command exceeds velocity limit for joint " << name_;
-        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str().c_str());
-        ss.str(""); ss.clear();
-    }
+    warnLimit(__PRETTY_FUNCTION__,
+              ": Command exceeds velocity limit for joint ",
+              velocity_rad_sec != velocity_old,
+              velocity_limit_exceeded_);
 
     double current_pos;
     readPositionRad(current_pos);
@@ -81,12 +106,10 @@ bool JointActive::commandVelocityRadSec(double velocity_rad_sec)
             velocity_rad_sec = std::max(0.0, velocity_rad_sec);
     }
 
-    if (velocity_rad_sec != velocity_old)
-    {
-        ss << ": Position limit reached for joint " << name_;
-        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str().c_str());
-        ss.str(""); ss.clear();
-    }
+    warnLimit(__PRETTY_FUNCTION__,
+              ": Position limit reached for joint ",
+              velocity_rad_sec != velocity_old,
+              position_limit_reached_);
 
     if (params_.flip_sign)
     {
@@ -102,6 +125,8 @@ bool JointActive::commandTorqueNm(double torque_nm)
 {
     if (!enabled_) return false;
 
+    cancelCyclicCommands();
+
     double torque_old = torque_nm;
     double max_torque = params_.max_torque_command_nm;
 
@@ -110,12 +135,10 @@ bool JointActive::commandTorqueNm(double torque_nm)
         torque_nm = std::min(max_torque, std::max(-max_torque, torque_nm));
     }
 
-    if (torque_nm != torque_old)
-    {
-        ss << ": Command exceeds torque limit for joint " << name_;
-        log(LogLevel::WARN, __PRETTY_FUNCTION__, ss.str().c_str());
-        ss.str(""); ss.clear();
-    }
+    warnLimit(__PRETTY_FUNCTION__,
+              ": Command exceeds torque limit for joint ",
+              torque_nm != torque_old,
+              torque_limit_exceeded_);
 
     if (params_.flip_sign)
     {
@@ -127,6 +150,18 @@ bool JointActive::commandTorqueNm(double torque_nm)
     return true;
 }
 
+void JointActive::warnLimit(const char* context, const char* message, bool violated, bool& logged)
+{
+    if (violated && !logged)
+    {
+        ss << message << name_;
+        log(LogLevel::WARN, context, ss.str().c_str());
+        ss.str(""); ss.clear();
+    }
+
+    logged = violated;
+}
+
 bool JointActive::readPositionRad(double& position_rad)
 {
     if (enabled_)
@@ -189,3 +224,273 @@ bool JointActive::readTempDegC(double& temp_deg_c)
 
     return true;
 }
+
+bool JointActive::commandTrajectory(std::unique_ptr<const Trajectory> trajectory)
+{
+    if (!enabled_) return false;
+
+    if (!trajectory->isValid())
+    {
+        ss << ": Invalid trajectory for joint " << name_;
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str().c_str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(trajectory_mutex_);
+
+    deleteRetiredTrajectories();
+
+    // the new trajectory replaces the current one in any case, an earlier cancellation that
+    // the cycle did not see yet must not stop it
+    cancel_trajectory_.store(false, std::memory_order_relaxed);
+
+    const Trajectory* replaced =
+        pending_trajectory_.exchange(trajectory.release(), std::memory_order_acq_rel);
+
+    // a trajectory that the cycle did not take over yet is never used
+    if (replaced)
+        delete replaced;
+    else
+        num_handed_over_trajectories_++;
+
+    return true;
+}
+
+bool JointActive::isTrajectoryFinished(double time_sec)
+{
+    // retired trajectories are only deleted with the mutex held
+    std::unique_lock<std::mutex> lock(trajectory_mutex_);
+
+    const Trajectory* pending = pending_trajectory_.load(std::memory_order_acquire);
+
+    if (pending) return pending->isFinished(time_sec);
+
+    if (cancel_trajectory_.load(std::memory_order_relaxed)) return true;
+
+    // the cycle took over the last trajectory but did not activate it yet
+    if (num_taken_trajectories_.load(std::memory_order_acquire) != num_handed_over_trajectories_)
+        return false;
+
+    const Trajectory* active = active_trajectory_.load(std::memory_order_acquire);
+
+    return !active || active->isFinished(time_sec);
+}
+
+void JointActive::cancelTrajectory()
+{
+    cancel_trajectory_.store(true, std::memory_order_relaxed);
+
+    if (!pending_trajectory_.load(std::memory_order_relaxed)) return;
+
+    std::unique_lock<std::mutex> lock(trajectory_mutex_);
+
+    const Trajectory* pending = pending_trajectory_.exchange(NULL, std::memory_order_acq_rel);
+
+    if (pending)
+    {
+        delete pending;
+        num_handed_over_trajectories_--;
+    }
+}
+
+void JointActive::cancelCyclicCommands()
+{
+    cancelTrajectory();
+    release_group_.store(true, std::memory_order_relaxed);
+}
+
+bool JointActive::takeGroupRelease()
+{
+    return release_group_.load(std::memory_order_relaxed)
+           && release_group_.exchange(false, std::memory_order_relaxed);
+}
+
+void JointActive::deleteRetiredTrajectories()
+{
+    const Trajectory* trajectory;
+
+    while (retired_trajectories_.pop(trajectory))
+    {
+        delete trajectory;
+    }
+}
+
+void JointActive::updateTrajectory(double time_sec)
+{
+    const Trajectory* active = active_trajectory_.load(std::memory_order_relaxed);
+    const Trajectory* trajectory = active;
+
+    if (cancel_trajectory_.load(std::memory_order_relaxed)
+        && cancel_trajectory_.exchange(false, std::memory_order_relaxed))
+    {
+        trajectory = NULL;
+    }
+
+    bool taken = false;
+
+    if (pending_trajectory_.load(std::memory_order_relaxed))
+    {
+        const Trajectory* pending =
+            pending_trajectory_.exchange(NULL, std::memory_order_acq_rel);
+
+        if (pending)
+        {
+            trajectory = pending;
+            taken = true;
+        }
+    }
+
+    if (trajectory != active)
+    {
+        active_trajectory_.store(trajectory, std::memory_order_release);
+
+        // holds at most three trajectories between two calls of commandTrajectory
+        if (active) retired_trajectories_.push(active);
+    }
+
+    if (taken) num_taken_trajectories_.fetch_add(1, std::memory_order_release);
+
+    if (!enabled_ || !trajectory)
+    {
+        has_set_point_ = false;
+        return;
+    }
+
+    TrajectoryPoint point;
+    trajectory->evaluate(time_sec, point);
+
+    if (trajectory->getMode() == TrajectoryMode::POSITION)
+    {
+        writeCyclicPositionRad(point.position_rad, time_sec);
+    }
+    else
+    {
+        writeCyclicVelocityRadSec(point.velocity_rad_sec);
+    }
+}
+
+void JointActive::enforcePositionLimits()
+{
+    double min_pos = params_.min_position_command_rad;
+    double max_pos = params_.max_position_command_rad;
+
+    if (!enabled_ || (min_pos == 0.0 && max_pos == 0.0)) return;
+
+    double position_rad;
+    readPositionRad(position_rad);
+
+    // highest speed towards each limit from which the joint can still stop in time
+    double accel = drive_->getProfileAccelerationRadSecSec();
+    double max_vel = 0.0;
+    double min_vel = 0.0;
+
+    if (position_rad < max_pos)
+    {
+        max_vel = accel > 0.0 ? std::sqrt(2.0 * accel * (max_pos - position_rad))
+                              : std::numeric_limits<double>::infinity();
+    }
+
+    if (position_rad > min_pos)
+    {
+        min_vel = accel > 0.0 ? -std::sqrt(2.0 * accel * (position_rad - min_pos))
+                              : -std::numeric_limits<double>::infinity();
+    }
+
+    if (params_.flip_sign)
+    {
+        drive_->limitVelocityRadSec(-max_vel, -min_vel);
+    }
+    else
+    {
+        drive_->limitVelocityRadSec(min_vel, max_vel);
+    }
+}
+
+void JointActive::writeCyclicPositionRad(double position_rad, double time_sec)
+{
+    double min_pos = params_.min_position_command_rad;
+    double max_pos = params_.max_position_command_rad;
+    double max_vel = params_.max_velocity_command_rad_sec;
+
+    if (!(min_pos == 0.0 && max_pos == 0.0))
+    {
+        position_rad = std::max(min_pos, std::min(max_pos, position_rad));
+    }
+
+    // start from the measured position and limit the set point rate to the maximum velocity
+    if (!has_set_point_)
+    {
+        readPositionRad(last_set_point_rad_);
+        last_set_point_time_sec_ = time_sec;
+        has_set_point_ = true;
+    }
+
+    if (max_vel != 0.0)
+    {
+        double max_step = max_vel * (time_sec - last_set_point_time_sec_);
+        position_rad = std::max(last_set_point_rad_ - max_step,
+                                std::min(last_set_point_rad_ + max_step, position_rad));
+    }
+
+    last_set_point_rad_ = position_rad;
+    last_set_point_time_sec_ = time_sec;
+
+    if (params_.flip_sign)
+    {
+        position_rad *= -1.0;
+    }
+
+    drive_->writeCyclicPositionRad(position_rad);
+}
+
+void JointActive::writeCyclicVelocityRadSec(double velocity_rad_sec)
+{
+    double min_pos = params_.min_position_command_rad;
+    double max_pos = params_.max_position_command_rad;
+    double max_vel = params_.max_velocity_command_rad_sec;
+
+    has_set_point_ = false;
+
+    if (max_vel != 0.0)
+    {
+        velocity_rad_sec = std::min(max_vel, std::max(-max_vel, velocity_rad_sec));
+    }
+
+    if (!(min_pos == 0.0 && max_pos == 0.0))
+    {
+        double current_pos;
+        readPositionRad(current_pos);
+
+        if (current_pos >= max_pos)
+            velocity_rad_sec = std::min(0.0, velocity_rad_sec);
+        else if (current_pos <= min_pos)
+            velocity_rad_sec = std::max(0.0, velocity_rad_sec);
+    }
+
+    if (params_.flip_sign)
+    {
+        velocity_rad_sec *= -1.0;
+    }
+
+    drive_->writeCyclicVelocityRadSec(velocity_rad_sec);
+}
+
+void JointActive::writeCyclicTorqueNm(double torque_nm)
+{
+    double max_torque = params_.max_torque_command_nm;
+
+    has_set_point_ = false;
+
+    if (max_torque != 0.0)
+    {
+        torque_nm = std::min(max_torque, std::max(-max_torque, torque_nm));
+    }
+
+    if (params_.flip_sign)
+    {
+        torque_nm *= -1.0;
+    }
+
+    drive_->writeCyclicTorqueNm(torque_nm);
+}
@@ -2,9 +2,16 @@
 
 #include "Joint.h"
 #include "PlatformDriverEthercatTypes.h"
+#include "SpscQueue.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 namespace platform_driver_ethercat
 {
+class Trajectory;
+
 class JointActive : public Joint
 {
   public:
@@ -12,6 +19,7 @@ class JointActive : public Joint
                 std::shared_ptr<CanDriveTwitter>& drive,
                 ActiveJointParams params,
                 bool enabled);
+    ~JointActive();
 
     bool commandPositionRad(double position_rad);
     bool commandVelocityRadSec(double velocity_rad_sec);
@@ -22,7 +30,104 @@ class JointActive : public Joint
     bool readTorqueNm(double& torque_nm);
     bool readTempDegC(double& temp_deg_c);
 
+    /**
+     * Hands a trajectory over to the process data cycle without blocking it.
+     * Any instantaneous command cancels the trajectory.
+     */
+    bool commandTrajectory(std::unique_ptr<const Trajectory> trajectory);
+
+    /**
+     * Checks if the current trajectory has passed its last waypoint.
+     * @return True if there is no trajectory or it is finished.
+     */
+    bool isTrajectoryFinished(double time_sec);
+
+    /**
+     * Interpolates the current trajectory and writes the cyclic set point to the drive.
+     * Called from the process data cycle.
+     */
+    void updateTrajectory(double time_sec);
+
+    /**
+     * Writes a cyclic synchronous position set point, limited like commandPositionRad.
+     * The set point rate is limited to the maximum velocity. Called from the process data cycle.
+     */
+    void writeCyclicPositionRad(double position_rad, double time_sec);
+
+    /**
+     * Writes a cyclic synchronous velocity set point, limited like commandVelocityRadSec.
+     * Called from the process data cycle.
+     */
+    void writeCyclicVelocityRadSec(double velocity_rad_sec);
+
+    /**
+     * Writes a cyclic synchronous torque set point, limited like commandTorqueNm.
+     * Called from the process data cycle.
+     */
+    void writeCyclicTorqueNm(double torque_nm);
+
+    /**
+     * Limits the velocity or torque set point of the current cycle so that the joint can still
+     * stop at its position limits with the profile acceleration of the drive.
+     * Called from the process data cycle after all set points were written.
+     */
+    void enforcePositionLimits();
+
+    /**
+     * Stops the current trajectory, the last cyclic set point remains active.
+     * Takes effect in the next cycle.
+     */
+    void cancelTrajectory();
+
+    /**
+     * Stops the current trajectory and releases the joint from its joint group, so that an
+     * instantaneous command is not overridden by cyclic set points. Takes effect in the next
+     * cycle.
+     */
+    void cancelCyclicCommands();
+
+    /**
+     * Checks if cancelCyclicCommands was called since the last check.
+     * Called from the process data cycle.
+     */
+    bool takeGroupRelease();
+
   private:
     ActiveJointParams params_;
+
+    // the cycle takes over the pending trajectory and hands replaced ones back for deletion,
+    // so it never locks or frees memory
+    std::atomic<const Trajectory*> pending_trajectory_;
+    std::atomic<const Trajectory*> active_trajectory_;
+    std::atomic<uint32_t> num_taken_trajectories_;
+    std::atomic<bool> cancel_trajectory_;
+    std::atomic<bool> release_group_;
+    SpscQueue<const Trajectory*, 4> retired_trajectories_;
+
+    // serializes the application threads, which delete retired and replaced trajectories
+    std::mutex trajectory_mutex_;
+    uint32_t num_handed_over_trajectories_;
+
+    // owned by the process data cycle
+    bool has_set_point_;
+    double last_set_point_rad_;
+    double last_set_point_time_sec_;
+
+    // limits violated by the last instantaneous command, each violation is logged once
+    bool position_limit_exceeded_;
+    bool velocity_limit_exceeded_;
+    bool position_limit_reached_;
+    bool torque_limit_exceeded_;
+
+    /**
+     * Logs a limit violation when it starts, so that saturated commands do not log every call.
+     */
+    void warnLimit(const char* context, const char* message, bool violated, bool& logged);
+
+    /**
+     * Deletes the trajectories that the cycle no longer uses.
+     * Called with the trajectory mutex held.
+     */
+    void deleteRetiredTrajectories();
 };
 }
@@ -0,0 +1,105 @@
+#include "JointEstimator.h"
+
+using namespace platform_driver_ethercat;
+
+JointEstimator::JointEstimator(JointEstimatorParams params, double sign)
+    : params_(params),
+      sign_(sign),
+      initialized_(false),
+      sample_time_sec_(0.0),
+      last_motor_velocity_rad_sec_(0.0),
+      x_(Eigen::Vector3d::Zero()),
+      P_(Eigen::Matrix3d::Zero())
+{
+    estimate_.write(Estimate{CycleStamp{0, 0.0, false, 0}, 0.0, 0.0, 0.0, 0.0, false});
+}
+
+void JointEstimator::update(const CycleStamp& stamp,
+                            double sample_time_sec,
+                            double motor_position_rad,
+                            double motor_velocity_rad_sec,
+                            double output_position_rad)
+{
+    double motor_pos_var = params_.motor_position_std_rad * params_.motor_position_std_rad;
+    double motor_vel_var = params_.motor_velocity_std_rad_sec * params_.motor_velocity_std_rad_sec;
+    double output_pos_var = params_.output_position_std_rad * params_.output_position_std_rad;
+    double backlash_var = params_.backlash_rad * params_.backlash_rad;
+
+    if (!initialized_)
+    {
+        x_ << output_position_rad, motor_velocity_rad_sec, output_position_rad - motor_position_rad;
+        P_ = Eigen::Vector3d(output_pos_var, motor_vel_var, output_pos_var + motor_pos_var)
+                 .asDiagonal();
+        initialized_ = true;
+    }
+    else
+    {
+        double dt = sample_time_sec - sample_time_sec_;
+
+        Eigen::Matrix3d F = Eigen::Matrix3d::Identity();
+        F(0, 1) = dt;
+
+        // white acceleration on position and velocity
+        double accel_var =
+            params_.acceleration_std_rad_sec_sec * params_.acceleration_std_rad_sec_sec;
+        Eigen::Matrix3d Q = Eigen::Matrix3d::Zero();
+        Q(0, 0) = 0.25 * dt * dt * dt * dt * accel_var;
+        Q(0, 1) = Q(1, 0) = 0.5 * dt * dt * dt * accel_var;
+        Q(1, 1) = dt * dt * accel_var;
+
+        // the gear crosses its backlash when the motor reverses
+        if (motor_velocity_rad_sec * last_motor_velocity_rad_sec_ < 0.0)
+        {
+            Q(2, 2) = backlash_var;
+        }
+
+        x_ = F * x_;
+        P_ = F * P_ * F.transpose() + Q;
+
+        correct(Eigen::RowVector3d(1.0, 0.0, -1.0), motor_position_rad, motor_pos_var);
+        correct(Eigen::RowVector3d(0.0, 1.0, 0.0), motor_velocity_rad_sec, motor_vel_var);
+        correct(Eigen::RowVector3d(1.0, 0.0, 0.0), output_position_rad, output_pos_var);
+    }
+
+    sample_time_sec_ = sample_time_sec;
+
+    if (motor_velocity_rad_sec != 0.0)
+    {
+        last_motor_velocity_rad_sec_ = motor_velocity_rad_sec;
+    }
+
+    estimate_.write(Estimate{stamp,
+                             sample_time_sec,
+                             sign_ * x_(0),
+                             sign_ * x_(1),
+                             sign_ * x_(2),
+                             true});
+}
+
+void JointEstimator::correct(const Eigen::RowVector3d& h, double z, double variance)
+{
+    double s = h * P_ * h.transpose() + variance;
+
+    if (!(s > 0.0)) return;
+
+    Eigen::Vector3d k = P_ * h.transpose() / s;
+
+    x_ += k * (z - h * x_);
+    P_ = (Eigen::Matrix3d::Identity() - k * h) * P_;
+}
+
+JointEstimate JointEstimator::read(double time_sec) const
+{
+    Estimate estimate = estimate_.read();
+
+    JointEstimate prediction;
+    prediction.stamp = estimate.stamp;
+    prediction.time_sec = time_sec;
+    prediction.position_rad =
+        estimate.position_rad + estimate.velocity_rad_sec * (time_sec - estimate.sample_time_sec);
+    prediction.velocity_rad_sec = estimate.velocity_rad_sec;
+    prediction.deflection_rad = estimate.deflection_rad;
+    prediction.valid = estimate.valid;
+
+    return prediction;
+}
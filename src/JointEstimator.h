@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Eigen/Dense>
+
+#include "PlatformDriverEthercatTypes.h"
+#include "SeqLock.h"
+
+namespace platform_driver_ethercat
+{
+
+/**
+ * Kalman filter fusing the motor and output encoders of a joint.
+ * The state holds output position, output velocity and the deflection between output and motor
+ * position. The deflection absorbs the gear backlash and the offset between the encoders, its
+ * uncertainty grows by the backlash whenever the motor reverses.
+ */
+class JointEstimator
+{
+  public:
+    /**
+     * The constructor
+     * @param sign Factor converting drive positions into joint positions, +1 or -1.
+     */
+    JointEstimator(JointEstimatorParams params, double sign);
+
+    /**
+     * Fuses the measurements of one cycle, called from the process data cycle only.
+     * @param sample_time_sec Monotonic time at which the drive latched the measurements.
+     * @param motor_position_rad Motor position scaled to the joint, in the drive frame.
+     * @param motor_velocity_rad_sec Motor velocity scaled to the joint, in the drive frame.
+     * @param output_position_rad Auxiliary encoder position, in the drive frame.
+     */
+    void update(const CycleStamp& stamp,
+                double sample_time_sec,
+                double motor_position_rad,
+                double motor_velocity_rad_sec,
+                double output_position_rad);
+
+    /**
+     * Returns the last estimate, predicted to the given time with constant velocity.
+     */
+    JointEstimate read(double time_sec) const;
+
+  private:
+    JointEstimatorParams params_;
+    double sign_;
+
+    // owned by the process data cycle
+    bool initialized_;
+    double sample_time_sec_;
+    double last_motor_velocity_rad_sec_;
+    Eigen::Vector3d x_;
+    Eigen::Matrix3d P_;
+
+    struct Estimate
+    {
+        CycleStamp stamp;
+        double sample_time_sec;
+        double position_rad;
+        double velocity_rad_sec;
+        double deflection_rad;
+        bool valid;
+    };
+
+    SeqLock<Estimate> estimate_;
+
+    /**
+     * Fuses one scalar measurement z = h * x.
+     */
+    void correct(const Eigen::RowVector3d& h, double z, double variance);
+};
+}
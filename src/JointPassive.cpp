@@ -8,6 +8,15 @@ using namespace platform_driver_ethercat;
 JointPassive::JointPassive(std::string name, std::shared_ptr<CanDriveTwitter>& drive, bool enabled)
     : Joint(name, drive, enabled) {}
 
+JointPassive::JointPassive(std::string name,
+                           std::shared_ptr<CanDriveTwitter>& drive,
+                           PassiveJointParams params,
+                           bool enabled)
+    : Joint(name, drive, enabled)
+{
+    drive_->setAuxiliaryVelocityFilter(params.velocity_filter_alpha, params.velocity_filter_beta);
+}
+
 bool JointPassive::commandPositionRad(double ) { return false; }
 
 bool JointPassive::commandVelocityRadSec(double ) { return false; }
@@ -32,8 +41,7 @@ bool JointPassive::readVelocityRadSec(double& velocity_rad_sec)
 {
     if (enabled_)
     {
-        // TODO
-        velocity_rad_sec = 0.0;
+        velocity_rad_sec = drive_->readAuxiliaryVelocityRadSec();
         return true;
     }
     else
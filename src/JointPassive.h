@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Joint.h"
+#include "PlatformDriverEthercatTypes.h"
 
 namespace platform_driver_ethercat
 {
@@ -8,6 +9,10 @@ class JointPassive : public Joint
 {
   public:
     JointPassive(std::string name, std::shared_ptr<CanDriveTwitter>& drive, bool enabled);
+    JointPassive(std::string name,
+                 std::shared_ptr<CanDriveTwitter>& drive,
+                 PassiveJointParams params,
+                 bool enabled);
 
     bool commandPositionRad(double position_rad);
     bool commandVelocityRadSec(double velocity_rad_sec);
@@ -10,7 +10,7 @@ using namespace platform_driver_ethercat;
 
 enum class LogLevel { DEBUG, INFO, WARN, ERROR, FATAL };
 
-inline void log(const LogLevel level, const std::string context, const std::string message)
+inline void log(const LogLevel level, const char* context, const char* message)
 {
     switch (level)
     {
@@ -18,36 +18,45 @@ inline void log(const LogLevel level, const std::string context, const std::stri
             #ifdef ROCK
             LOG_DEBUG_S << context << message;
             #elif ROS2
-            RCLCPP_DEBUG(rclcpp::get_logger(context), "%s", message.c_str());
+            // the logger is only looked up if debug output is enabled
+            if (rcutils_logging_logger_is_enabled_for(context, RCUTILS_LOG_SEVERITY_DEBUG))
+            {
+                RCLCPP_DEBUG(rclcpp::get_logger(context), "%s", message);
+            }
             #endif
             break;
         case LogLevel::INFO:
             #ifdef ROCK
             LOG_INFO_S << context << message;
             #elif ROS2
-            RCLCPP_INFO(rclcpp::get_logger(context), "%s", message.c_str());
+            RCLCPP_INFO(rclcpp::get_logger(context), "%s", message);
             #endif
             break;
         case LogLevel::WARN:
             #ifdef ROCK
             LOG_WARN_S << context << message;
             #elif ROS2
-            RCLCPP_WARN(rclcpp::get_logger(context), "%s", message.c_str());
+            RCLCPP_WARN(rclcpp::get_logger(context), "%s", message);
             #endif
             break;
         case LogLevel::ERROR:
             #ifdef ROCK
             LOG_ERROR_S << context << message;
             #elif ROS2
-            RCLCPP_ERROR(rclcpp::get_logger(context), "%s", message.c_str());
+            RCLCPP_ERROR(rclcpp::get_logger(context), "%s", message);
             #endif
             break;
         case LogLevel::FATAL:
             #ifdef ROCK
             LOG_FATAL_S << context << message;
             #elif ROS2
-            RCLCPP_FATAL(rclcpp::get_logger(context), "%s", message.c_str());
+            RCLCPP_FATAL(rclcpp::get_logger(context), "%s", message);
             #endif
             break;
     }
 }
+
+inline void log(const LogLevel level, const std::string& context, const std::string& message)
+{
+    log(level, context.c_str(), message.c_str());
+}
@@ -3,9 +3,13 @@
 #include <signal.h>
 #include <sys/time.h>
 #include <Eigen/Dense>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <future>
 #include <iostream>
+#include <limits>
 #include <tuple>
 #include <vector>
 
@@ -13,8 +17,13 @@
 #include "CanDriveTwitter.h"
 #include "EthercatInterface.h"
 #include "JointActive.h"
+#include "JointEstimator.h"
 #include "JointPassive.h"
 #include "PlatformDriverEthercat.h"
+#include "SeqLock.h"
+#include "SharedCommands.h"
+#include "SharedState.h"
+#include "Trajectory.h"
 
 #include "Logging.hpp"
 #include <sstream>
@@ -22,27 +31,69 @@ static std::stringstream ss;
 
 using namespace platform_driver_ethercat;
 
+struct PlatformDriverEthercat::JointGroup
+{
+    std::vector<size_t> joints;  // joint handles of the members
+
+    // staged by the application
+    std::mutex stage_mutex;
+    std::vector<SharedJointCommand> staged;
+
+    // last commit, written under the stage mutex
+    SequenceCounter commit_sequence;
+    std::vector<SharedJointCommand> committed;
+    uint64_t commit_count;
+    double commit_time_sec;
+
+    // owned by the EtherCAT cycle
+    std::vector<SharedJointCommand> applied;
+    uint64_t applied_count;
+    double applied_commit_time_sec;
+    bool awaiting_send;
+    uint64_t num_latencies;
+    JointGroupStats stats;
+
+    SeqLock<JointGroupStats> published_stats;
+};
+
 PlatformDriverEthercat::PlatformDriverEthercat(std::string dev_address, unsigned int num_slaves)
-    : ethercat_(new EthercatInterface(dev_address, num_slaves))
+    : joint_states_sequence_(new SequenceCounter()),
+      joint_states_stamp_{0, 0.0, false, 0},
+      ethercat_(new EthercatInterface(dev_address, num_slaves))
 {
+    ethercat_->addCycleCallback([this](const CycleInfo& cycle) { updateJoints(cycle); });
 }
 
-PlatformDriverEthercat::~PlatformDriverEthercat() {}
+PlatformDriverEthercat::~PlatformDriverEthercat()
+{
+    // the cycle callbacks refer to the platform, so the cycle has to stop first
+    if (ethercat_->isInit())
+    {
+        ethercat_->close();
+    }
+}
 
 void PlatformDriverEthercat::addDriveTwitter(unsigned int slave_id,
                                              std::string name,
                                              DriveParams params)
 {
     auto drive = std::make_shared<CanDriveTwitter>(ethercat_, slave_id, name, params);
+
+    // a drive rejected by the interface, e.g. for a used slave id, never gets process data
+    if (!ethercat_->addDevice(drive)) return;
+
     can_drives_.insert(std::make_pair(drive->getDeviceName(), drive));
-    ethercat_->addDevice(drive);
+    drive_list_.push_back(drive);
 }
 
 void PlatformDriverEthercat::addAtiFts(unsigned int slave_id, std::string name)
 {
     auto fts = std::make_shared<CanDeviceAtiFts>(ethercat_, slave_id, name);
+
+    if (!ethercat_->addDevice(fts)) return;
+
     can_fts_.insert(std::make_pair(fts->getDeviceName(), fts));
-    ethercat_->addDevice(fts);
+    fts_list_.push_back(fts);
 }
 
 void PlatformDriverEthercat::addActiveJoint(std::string name,
@@ -54,6 +105,7 @@ void PlatformDriverEthercat::addActiveJoint(std::string name,
         new JointActive(name, can_drives_.at(drive), params, enabled));
     joints_.insert(std::make_pair(joint->getName(), joint));
     active_joints_.insert(std::make_pair(joint->getName(), joint));
+    registerJoint(joint.get(), enabled ? joint.get() : NULL, can_drives_.at(drive).get(), &params);
 }
 
 void PlatformDriverEthercat::addPassiveJoint(std::string name, std::string drive, bool enabled)
@@ -61,6 +113,304 @@ void PlatformDriverEthercat::addPassiveJoint(std::string name, std::string drive
     std::shared_ptr<JointPassive> joint(new JointPassive(name, can_drives_.at(drive), enabled));
     joints_.insert(std::make_pair(joint->getName(), joint));
     passive_joints_.insert(std::make_pair(joint->getName(), joint));
+    registerJoint(joint.get(), NULL, can_drives_.at(drive).get(), NULL);
+}
+
+void PlatformDriverEthercat::addPassiveJoint(std::string name,
+                                             std::string drive,
+                                             PassiveJointParams params,
+                                             bool enabled)
+{
+    std::shared_ptr<JointPassive> joint(
+        new JointPassive(name, can_drives_.at(drive), params, enabled));
+    joints_.insert(std::make_pair(joint->getName(), joint));
+    passive_joints_.insert(std::make_pair(joint->getName(), joint));
+    registerJoint(joint.get(), NULL, can_drives_.at(drive).get(), NULL);
+}
+
+void PlatformDriverEthercat::registerJoint(Joint* joint,
+                                           JointActive* active_joint,
+                                           CanDriveTwitter* drive,
+                                           const ActiveJointParams* params)
+{
+    const double inf = std::numeric_limits<double>::infinity();
+
+    double min_pos = -inf;
+    double max_pos = inf;
+    double max_vel = inf;
+    double max_torque = inf;
+
+    if (params)
+    {
+        if (!(params->min_position_command_rad == 0.0 && params->max_position_command_rad == 0.0))
+        {
+            min_pos = params->min_position_command_rad;
+            max_pos = params->max_position_command_rad;
+        }
+
+        if (params->max_velocity_command_rad_sec != 0.0)
+        {
+            max_vel = params->max_velocity_command_rad_sec;
+        }
+
+        if (params->max_torque_command_nm != 0.0)
+        {
+            max_torque = params->max_torque_command_nm;
+        }
+    }
+
+    joint_list_.push_back(joint);
+    commandable_joints_.push_back(active_joint);
+    joint_drives_.push_back(drive);
+    joint_signs_.push_back((params && params->flip_sign) ? -1.0 : 1.0);
+    joint_min_positions_rad_.push_back(min_pos);
+    joint_max_positions_rad_.push_back(max_pos);
+    joint_max_velocities_rad_sec_.push_back(max_vel);
+    joint_max_torques_nm_.push_back(max_torque);
+    bulk_commands_.push_back(0.0);
+    bulk_positions_rad_.push_back(0.0);
+
+    joint_positions_rad_.push_back(std::numeric_limits<double>::quiet_NaN());
+    joint_velocities_rad_sec_.push_back(std::numeric_limits<double>::quiet_NaN());
+    joint_torques_nm_.push_back(std::numeric_limits<double>::quiet_NaN());
+
+    joint_estimators_.push_back(NULL);
+}
+
+void PlatformDriverEthercat::addTelemetry(std::string device_name,
+                                          std::string telemetry_name,
+                                          uint16_t index,
+                                          uint8_t subindex,
+                                          TelemetryType type,
+                                          double scale)
+{
+    unsigned int slave_id = can_drives_.count(device_name)
+                                ? can_drives_.at(device_name)->getSlaveId()
+                                : can_fts_.at(device_name)->getSlaveId();
+
+    int id = ethercat_->addTelemetry(slave_id, index, subindex, type, scale);
+
+    if (id >= 0)
+    {
+        telemetry_ids_[std::make_pair(device_name, telemetry_name)] = id;
+    }
+}
+
+void PlatformDriverEthercat::addDriveTelemetry(std::string drive_name)
+{
+    for (auto& telemetry : can_drives_.at(drive_name)->addTelemetry())
+    {
+        if (telemetry.second >= 0)
+        {
+            telemetry_ids_[std::make_pair(drive_name, telemetry.first)] = telemetry.second;
+        }
+    }
+}
+
+void PlatformDriverEthercat::addFtsTelemetry(std::string fts_name)
+{
+    for (auto& telemetry : can_fts_.at(fts_name)->addTelemetry())
+    {
+        if (telemetry.second >= 0)
+        {
+            telemetry_ids_[std::make_pair(fts_name, telemetry.first)] = telemetry.second;
+        }
+    }
+}
+
+void PlatformDriverEthercat::setTelemetryPeriod(unsigned int cycles)
+{
+    ethercat_->setMailboxPeriod(cycles);
+}
+
+bool PlatformDriverEthercat::enableSharedState(std::string shm_name)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Shared state must be enabled before init");
+        return false;
+    }
+
+    if (shared_state_)
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Shared state is already enabled");
+        return false;
+    }
+
+    std::shared_ptr<SharedStateWriter> shared_state(new SharedStateWriter());
+
+    if (!shared_state->open(shm_name))
+    {
+        return false;
+    }
+
+    shared_state_ = shared_state;
+
+    // runs after updateJoints, which was added in the constructor
+    ethercat_->addCycleCallback([this](const CycleInfo& cycle) { publishSharedState(cycle); });
+
+    return true;
+}
+
+bool PlatformDriverEthercat::enableSharedCommands(std::string shm_name, double timeout_sec)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Shared commands must be enabled before init");
+        return false;
+    }
+
+    if (shared_commands_)
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Shared commands are already enabled");
+        return false;
+    }
+
+    std::shared_ptr<SharedCommandServer> shared_commands(new SharedCommandServer());
+
+    if (!shared_commands->open(shm_name, timeout_sec))
+    {
+        return false;
+    }
+
+    shared_commands_ = shared_commands;
+
+    return true;
+}
+
+void PlatformDriverEthercat::initSharedState()
+{
+    SharedState& state = shared_state_->beginWrite();
+
+    state.num_joints = std::min(joint_list_.size(), SHARED_STATE_MAX_JOINTS);
+    state.num_drives = std::min(drive_list_.size(), SHARED_STATE_MAX_DRIVES);
+    state.num_fts = std::min(fts_list_.size(), SHARED_STATE_MAX_FTS);
+
+    for (size_t i = 0; i < state.num_joints; i++)
+    {
+        strncpy(state.joints[i].name,
+                joint_list_[i]->getName().c_str(),
+                SHARED_STATE_NAME_LENGTH - 1);
+    }
+
+    for (size_t i = 0; i < state.num_drives; i++)
+    {
+        strncpy(state.drives[i].name,
+                drive_list_[i]->getDeviceName().c_str(),
+                SHARED_STATE_NAME_LENGTH - 1);
+    }
+
+    for (size_t i = 0; i < state.num_fts; i++)
+    {
+        strncpy(state.fts[i].name,
+                fts_list_[i]->getDeviceName().c_str(),
+                SHARED_STATE_NAME_LENGTH - 1);
+    }
+
+    shared_state_->endWrite();
+
+    if (state.num_joints < joint_list_.size() || state.num_drives < drive_list_.size()
+        || state.num_fts < fts_list_.size())
+    {
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, "Too many devices, shared state is truncated");
+    }
+}
+
+void PlatformDriverEthercat::publishSharedState(const CycleInfo& cycle)
+{
+    SharedState& state = shared_state_->beginWrite();
+
+    state.cycle.sequence = cycle.sequence;
+    state.cycle.time_sec = cycle.time_sec;
+    state.cycle.wkc = cycle.wkc;
+    state.cycle.expected_wkc = cycle.expected_wkc;
+    state.cycle.dc_time_ns = cycle.dc_time_ns;
+
+    if (cycle.wkc < cycle.expected_wkc)
+    {
+        state.cycle.num_incomplete_frames++;
+    }
+
+    // joint states were updated earlier in this cycle
+    for (size_t i = 0; i < state.num_joints; i++)
+    {
+        state.joints[i].position_rad = joint_positions_rad_[i];
+        state.joints[i].velocity_rad_sec = joint_velocities_rad_sec_[i];
+        state.joints[i].torque_nm = joint_torques_nm_[i];
+    }
+
+    for (size_t i = 0; i < state.num_drives; i++)
+    {
+        uint16_t status_word = drive_list_[i]->readStatusWord();
+
+        state.drives[i].status_word = status_word;
+        state.drives[i].fault = (status_word & 0x0008) != 0;
+    }
+
+    for (size_t i = 0; i < state.num_fts; i++)
+    {
+        state.fts[i].wrench = fts_list_[i]->readWrench();
+    }
+
+    shared_state_->endWrite();
+}
+
+bool PlatformDriverEthercat::setCycleController(
+    std::function<void(const CycleControllerInput& input, CycleControllerOutput& output)>
+        controller)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    if (controller && !ethercat_->enableEarlyOutputs()) return false;
+
+    cycle_controller_ = std::move(controller);
+
+    return true;
+}
+
+bool PlatformDriverEthercat::waitForNextCycle(double timeout_sec)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return ethercat_->waitForNextCycle(timeout_sec);
+}
+
+int PlatformDriverEthercat::enableCycleEvents(unsigned int cycles)
+{
+    return ethercat_->enableCycleEvents(cycles);
+}
+
+bool PlatformDriverEthercat::enableCycleWorkers(std::vector<int> cpus)
+{
+    return ethercat_->enableWorkers(cpus);
+}
+
+bool PlatformDriverEthercat::setCyclePeriod(double period_sec)
+{
+    return ethercat_->setCyclePeriod(period_sec);
+}
+
+bool PlatformDriverEthercat::enablePipelinedCycle() { return ethercat_->enablePipelinedCycle(); }
+
+bool PlatformDriverEthercat::readCyclePhaseStats(CyclePhaseStats& stats)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    stats = ethercat_->readCyclePhaseStats();
+
+    return true;
 }
 
 bool PlatformDriverEthercat::initPlatform()
@@ -69,6 +419,25 @@ bool PlatformDriverEthercat::initPlatform()
     log(LogLevel::DEBUG, __PRETTY_FUNCTION__, ss.str());
     ss.str(""); ss.clear();
 
+    // before the EtherCAT cycle starts publishing
+    if (shared_state_)
+    {
+        initSharedState();
+    }
+
+    if (shared_commands_)
+    {
+        shared_commands_->setJointNames(getJointNames());
+    }
+
+    cyclic_command_modes_.assign(joint_list_.size(), SharedCommandMode::NONE);
+    group_command_modes_.assign(joint_list_.size(), SharedCommandMode::NONE);
+    group_command_values_.assign(joint_list_.size(), 0.0);
+    controller_positions_rad_.resize(joint_list_.size());
+    controller_velocities_rad_sec_.resize(joint_list_.size());
+    controller_torques_nm_.resize(joint_list_.size());
+    controller_wrenches_.resize(fts_list_.size());
+
     if (!ethercat_->init())
     {
         ss << "Failed to initialize platform";
@@ -270,33 +639,989 @@ bool PlatformDriverEthercat::readJointTempDegC(std::string joint_name, double& t
     return joints_.at(joint_name)->readTempDegC(temp_deg_c);
 }
 
-void PlatformDriverEthercat::readFtsForceN(std::string fts_name, double& fx, double& fy, double& fz)
+bool PlatformDriverEthercat::readTelemetry(std::string device_name,
+                                           std::string telemetry_name,
+                                           TelemetryValue& value)
 {
     if (!ethercat_->isInit())
     {
         log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
     }
 
-    Eigen::Vector3d force = can_fts_.at(fts_name)->readForceN();
+    value = ethercat_->readTelemetry(
+        telemetry_ids_.at(std::make_pair(device_name, telemetry_name)));
 
-    fx = force[0];
-    fy = force[1];
-    fz = force[2];
+    return value.valid;
 }
 
-void PlatformDriverEthercat::readFtsTorqueNm(std::string fts_name,
-                                             double& tx,
-                                             double& ty,
-                                             double& tz)
+bool PlatformDriverEthercat::getJointHandle(const std::string& joint_name, JointHandle& joint)
+{
+    for (size_t i = 0; i < joint_list_.size(); i++)
+    {
+        if (joint_list_[i]->getName() == joint_name)
+        {
+            joint.index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<std::string> PlatformDriverEthercat::getJointNames()
+{
+    std::vector<std::string> names;
+
+    for (auto& joint : joint_list_)
+    {
+        names.push_back(joint->getName());
+    }
+
+    return names;
+}
+
+bool PlatformDriverEthercat::commandJointPositionRad(JointHandle joint, double position_rad)
 {
     if (!ethercat_->isInit())
     {
         log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
     }
 
-    Eigen::Vector3d torque = can_fts_.at(fts_name)->readTorqueNm();
+    return joint_list_.at(joint.index)->commandPositionRad(position_rad);
+}
 
-    tx = torque[0];
-    ty = torque[1];
-    tz = torque[2];
+bool PlatformDriverEthercat::commandJointVelocityRadSec(JointHandle joint, double velocity_rad_sec)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->commandVelocityRadSec(velocity_rad_sec);
+}
+
+bool PlatformDriverEthercat::commandJointTorqueNm(JointHandle joint, double torque_nm)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->commandTorqueNm(torque_nm);
+}
+
+bool PlatformDriverEthercat::readJointPositionRad(JointHandle joint, double& position_rad)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->readPositionRad(position_rad);
+}
+
+bool PlatformDriverEthercat::readJointVelocityRadSec(JointHandle joint, double& velocity_rad_sec)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->readVelocityRadSec(velocity_rad_sec);
+}
+
+bool PlatformDriverEthercat::readJointTorqueNm(JointHandle joint, double& torque_nm)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->readTorqueNm(torque_nm);
+}
+
+bool PlatformDriverEthercat::readJointTempDegC(JointHandle joint, double& temp_deg_c)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return joint_list_.at(joint.index)->readTempDegC(temp_deg_c);
+}
+
+size_t PlatformDriverEthercat::getNumJoints() { return joint_list_.size(); }
+
+bool PlatformDriverEthercat::readJointStates(double* positions_rad,
+                                             double* velocities_rad_sec,
+                                             double* torques_nm)
+{
+    CycleStamp stamp;
+
+    return readJointStates(positions_rad, velocities_rad_sec, torques_nm, stamp);
+}
+
+bool PlatformDriverEthercat::readJointStates(double* positions_rad,
+                                             double* velocities_rad_sec,
+                                             double* torques_nm,
+                                             CycleStamp& stamp)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    uint32_t sequence;
+
+    do
+    {
+        sequence = joint_states_sequence_->beginRead();
+
+        stamp = joint_states_stamp_;
+        if (positions_rad)
+            std::copy(joint_positions_rad_.begin(), joint_positions_rad_.end(), positions_rad);
+        if (velocities_rad_sec)
+            std::copy(joint_velocities_rad_sec_.begin(),
+                      joint_velocities_rad_sec_.end(),
+                      velocities_rad_sec);
+        if (torques_nm)
+            std::copy(joint_torques_nm_.begin(), joint_torques_nm_.end(), torques_nm);
+    } while (joint_states_sequence_->retryRead(sequence));
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readJointState(JointHandle joint,
+                                            double& position_rad,
+                                            double& velocity_rad_sec,
+                                            double& torque_nm,
+                                            CycleStamp& stamp)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    if (joint.index >= joint_list_.size())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Invalid joint handle");
+        return false;
+    }
+
+    uint32_t sequence;
+
+    do
+    {
+        sequence = joint_states_sequence_->beginRead();
+
+        stamp = joint_states_stamp_;
+        position_rad = joint_positions_rad_[joint.index];
+        velocity_rad_sec = joint_velocities_rad_sec_[joint.index];
+        torque_nm = joint_torques_nm_[joint.index];
+    } while (joint_states_sequence_->retryRead(sequence));
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readJointState(std::string joint_name,
+                                            double& position_rad,
+                                            double& velocity_rad_sec,
+                                            double& torque_nm,
+                                            CycleStamp& stamp)
+{
+    JointHandle joint;
+
+    if (!getJointHandle(joint_name, joint))
+    {
+        ss << "Unknown joint " << joint_name;
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    return readJointState(joint, position_rad, velocity_rad_sec, torque_nm, stamp);
+}
+
+bool PlatformDriverEthercat::enableJointEstimator(std::string joint_name,
+                                                  JointEstimatorParams params)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Joint estimators must be enabled before init");
+        return false;
+    }
+
+    JointHandle joint;
+
+    if (!getJointHandle(joint_name, joint) || !commandable_joints_[joint.index])
+    {
+        ss << "Joint " << joint_name << " is not an enabled active joint";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    joint_estimators_[joint.index].reset(
+        new JointEstimator(params, joint_signs_[joint.index]));
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readJointEstimate(JointHandle joint, JointEstimate& estimate)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    if (joint.index >= joint_list_.size())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Invalid joint handle");
+        return false;
+    }
+
+    if (!joint_estimators_[joint.index])
+    {
+        ss << "Joint " << joint_list_[joint.index]->getName() << " has no estimator";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    estimate = joint_estimators_[joint.index]->read(EthercatInterface::getTimeSec());
+
+    return estimate.valid;
+}
+
+bool PlatformDriverEthercat::readJointEstimate(std::string joint_name, JointEstimate& estimate)
+{
+    JointHandle joint;
+
+    if (!getJointHandle(joint_name, joint))
+    {
+        ss << "Unknown joint " << joint_name;
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    return readJointEstimate(joint, estimate);
+}
+
+bool PlatformDriverEthercat::commandJointPositionsRad(const double* positions_rad)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(bulk_command_mutex_);
+
+    size_t num_joints = joint_list_.size();
+    double* commands = bulk_commands_.data();
+    const double* sign = joint_signs_.data();
+    const double* min_pos = joint_min_positions_rad_.data();
+    const double* max_pos = joint_max_positions_rad_.data();
+
+    for (size_t i = 0; i < num_joints; i++)
+    {
+        commands[i] = sign[i] * std::max(min_pos[i], std::min(max_pos[i], positions_rad[i]));
+    }
+
+    commandDrives(positions_rad, &CanDriveTwitter::commandPositionRad);
+
+    return true;
+}
+
+bool PlatformDriverEthercat::commandJointVelocitiesRadSec(const double* velocities_rad_sec)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(bulk_command_mutex_);
+
+    readJointStates(bulk_positions_rad_.data(), NULL, NULL);
+
+    size_t num_joints = joint_list_.size();
+    double* commands = bulk_commands_.data();
+    const double* positions = bulk_positions_rad_.data();
+    const double* sign = joint_signs_.data();
+    const double* min_pos = joint_min_positions_rad_.data();
+    const double* max_pos = joint_max_positions_rad_.data();
+    const double* max_vel = joint_max_velocities_rad_sec_.data();
+
+    for (size_t i = 0; i < num_joints; i++)
+    {
+        double velocity = std::min(max_vel[i], std::max(-max_vel[i], velocities_rad_sec[i]));
+        // do not drive further past a position limit
+        velocity = positions[i] >= max_pos[i] ? std::min(0.0, velocity) : velocity;
+        velocity = positions[i] <= min_pos[i] ? std::max(0.0, velocity) : velocity;
+        commands[i] = sign[i] * velocity;
+    }
+
+    commandDrives(velocities_rad_sec, &CanDriveTwitter::commandVelocityRadSec);
+
+    return true;
+}
+
+bool PlatformDriverEthercat::commandJointTorquesNm(const double* torques_nm)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(bulk_command_mutex_);
+
+    size_t num_joints = joint_list_.size();
+    double* commands = bulk_commands_.data();
+    const double* sign = joint_signs_.data();
+    const double* max_torque = joint_max_torques_nm_.data();
+
+    for (size_t i = 0; i < num_joints; i++)
+    {
+        commands[i] = sign[i] * std::min(max_torque[i], std::max(-max_torque[i], torques_nm[i]));
+    }
+
+    commandDrives(torques_nm, &CanDriveTwitter::commandTorqueNm);
+
+    return true;
+}
+
+void PlatformDriverEthercat::commandDrives(const double* commands,
+                                           void (CanDriveTwitter::*command)(double))
+{
+    for (size_t i = 0; i < joint_list_.size(); i++)
+    {
+        if (!commandable_joints_[i] || std::isnan(commands[i])) continue;
+
+        commandable_joints_[i]->cancelCyclicCommands();
+        (joint_drives_[i]->*command)(bulk_commands_[i]);
+    }
+}
+
+bool PlatformDriverEthercat::readDriveFaultHistory(std::string drive_name,
+                                                   std::vector<DriveFaultRecord>& records)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    can_drives_.at(drive_name)->readFaultRecords(records);
+
+    return true;
+}
+
+void PlatformDriverEthercat::readFtsForceN(std::string fts_name, double& fx, double& fy, double& fz)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+    }
+
+    Eigen::Vector3d force = can_fts_.at(fts_name)->readForceN();
+
+    fx = force[0];
+    fy = force[1];
+    fz = force[2];
+}
+
+void PlatformDriverEthercat::readFtsTorqueNm(std::string fts_name,
+                                             double& tx,
+                                             double& ty,
+                                             double& tz)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+    }
+
+    Eigen::Vector3d torque = can_fts_.at(fts_name)->readTorqueNm();
+
+    tx = torque[0];
+    ty = torque[1];
+    tz = torque[2];
+}
+
+bool PlatformDriverEthercat::addJointGroup(std::string group_name,
+                                           std::vector<std::string> joint_names)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    if (joint_groups_by_name_.count(group_name))
+    {
+        ss << "Joint group " << group_name << " already exists";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    std::shared_ptr<JointGroup> group(new JointGroup());
+
+    for (auto& joint_name : joint_names)
+    {
+        JointHandle joint;
+
+        if (!getJointHandle(joint_name, joint) || !commandable_joints_[joint.index])
+        {
+            ss << "Joint " << joint_name << " is not an enabled active joint";
+            log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+            ss.str(""); ss.clear();
+            return false;
+        }
+
+        group->joints.push_back(joint.index);
+    }
+
+    SharedJointCommand none{SharedCommandMode::NONE, 0.0};
+
+    group->staged.assign(joint_names.size(), none);
+    group->committed.assign(joint_names.size(), none);
+    group->applied.assign(joint_names.size(), none);
+    group->commit_count = 0;
+    group->commit_time_sec = 0.0;
+    group->applied_count = 0;
+    group->applied_commit_time_sec = 0.0;
+    group->awaiting_send = false;
+    group->num_latencies = 0;
+    group->stats = JointGroupStats{0, 0, 0, 0.0, 0.0, 0.0};
+    group->published_stats.write(group->stats);
+
+    joint_groups_.push_back(group);
+    joint_groups_by_name_.insert(std::make_pair(group_name, group));
+
+    return true;
+}
+
+bool PlatformDriverEthercat::stageJointGroupCommand(const std::string& group_name,
+                                                    size_t member,
+                                                    SharedCommandMode mode,
+                                                    double value)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    JointGroup& group = *joint_groups_by_name_.at(group_name);
+
+    if (member >= group.joints.size())
+    {
+        ss << "Joint group " << group_name << " has no member " << member;
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock(group.stage_mutex);
+
+    group.staged[member].mode = std::isnan(value) ? SharedCommandMode::NONE : mode;
+    group.staged[member].value = value;
+
+    return true;
+}
+
+bool PlatformDriverEthercat::stageJointGroupPositionRad(std::string group_name,
+                                                        size_t member,
+                                                        double position_rad)
+{
+    return stageJointGroupCommand(group_name, member, SharedCommandMode::POSITION, position_rad);
+}
+
+bool PlatformDriverEthercat::stageJointGroupVelocityRadSec(std::string group_name,
+                                                           size_t member,
+                                                           double velocity_rad_sec)
+{
+    return stageJointGroupCommand(
+        group_name, member, SharedCommandMode::VELOCITY, velocity_rad_sec);
+}
+
+bool PlatformDriverEthercat::stageJointGroupTorqueNm(std::string group_name,
+                                                     size_t member,
+                                                     double torque_nm)
+{
+    return stageJointGroupCommand(group_name, member, SharedCommandMode::TORQUE, torque_nm);
+}
+
+bool PlatformDriverEthercat::commitJointGroup(std::string group_name)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    JointGroup& group = *joint_groups_by_name_.at(group_name);
+
+    std::unique_lock<std::mutex> lock(group.stage_mutex);
+
+    group.commit_sequence.beginWrite();
+    std::copy(group.staged.begin(), group.staged.end(), group.committed.begin());
+    group.commit_count++;
+    group.commit_time_sec = EthercatInterface::getTimeSec();
+    group.commit_sequence.endWrite();
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readJointGroupStats(std::string group_name, JointGroupStats& stats)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    stats = joint_groups_by_name_.at(group_name)->published_stats.read();
+
+    return true;
+}
+
+void PlatformDriverEthercat::updateJointGroups(const CycleInfo& cycle)
+{
+    for (auto& group_ptr : joint_groups_)
+    {
+        JointGroup& group = *group_ptr;
+        bool stats_changed = false;
+
+        // the received frame was sent with the commit applied in the last cycle
+        if (group.awaiting_send)
+        {
+            double latency_sec = cycle.send_time_sec - group.applied_commit_time_sec;
+
+            group.num_latencies++;
+            group.stats.last_latency_sec = latency_sec;
+            group.stats.mean_latency_sec +=
+                (latency_sec - group.stats.mean_latency_sec) / group.num_latencies;
+            group.stats.max_latency_sec = std::max(group.stats.max_latency_sec, latency_sec);
+            group.awaiting_send = false;
+            stats_changed = true;
+        }
+
+        // a commit in progress is taken over in the next cycle rather than waiting for it
+        uint32_t sequence;
+
+        if (group.commit_sequence.tryBeginRead(sequence))
+        {
+            uint64_t commit_count = group.commit_count;
+            double commit_time_sec = group.commit_time_sec;
+
+            if (commit_count != group.applied_count)
+            {
+                std::copy(group.committed.begin(), group.committed.end(), group.applied.begin());
+            }
+
+            if (!group.commit_sequence.retryRead(sequence) && commit_count != group.applied_count)
+            {
+                group.stats.commits = commit_count;
+                group.stats.applied_commits++;
+                group.stats.superseded_commits += commit_count - group.applied_count - 1;
+                group.applied_count = commit_count;
+                group.applied_commit_time_sec = commit_time_sec;
+                group.awaiting_send = true;
+                stats_changed = true;
+
+                for (size_t m = 0; m < group.joints.size(); m++)
+                {
+                    group_command_modes_[group.joints[m]] = group.applied[m].mode;
+                    group_command_values_[group.joints[m]] = group.applied[m].value;
+                }
+            }
+        }
+
+        if (stats_changed)
+        {
+            group.published_stats.write(group.stats);
+        }
+    }
+}
+
+bool PlatformDriverEthercat::commandJointTrajectory(std::string joint_name,
+                                                    std::vector<TrajectoryPoint> trajectory,
+                                                    TrajectoryMode mode)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    std::unique_ptr<const Trajectory> joint_trajectory(
+        new Trajectory(std::move(trajectory), mode, EthercatInterface::getTimeSec()));
+
+    return active_joints_.at(joint_name)->commandTrajectory(std::move(joint_trajectory));
+}
+
+bool PlatformDriverEthercat::commandJointsTrajectory(
+    std::vector<std::string> joint_names,
+    std::vector<std::vector<TrajectoryPoint>> trajectories,
+    TrajectoryMode mode)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    if (joint_names.size() != trajectories.size())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Number of joints and trajectories differ");
+        return false;
+    }
+
+    double start_time_sec = EthercatInterface::getTimeSec();
+    bool success = true;
+
+    for (size_t i = 0; i < joint_names.size(); i++)
+    {
+        std::unique_ptr<const Trajectory> joint_trajectory(
+            new Trajectory(std::move(trajectories[i]), mode, start_time_sec));
+
+        success &=
+            active_joints_.at(joint_names[i])->commandTrajectory(std::move(joint_trajectory));
+    }
+
+    return success;
+}
+
+bool PlatformDriverEthercat::isJointTrajectoryFinished(std::string joint_name)
+{
+    return active_joints_.at(joint_name)->isTrajectoryFinished(EthercatInterface::getTimeSec());
+}
+
+void PlatformDriverEthercat::updateJoints(const CycleInfo& cycle)
+{
+    double time_sec = cycle.time_sec;
+
+    joint_states_sequence_->beginWrite();
+
+    joint_states_stamp_ = cycle.getStamp();
+
+    for (size_t i = 0; i < joint_list_.size(); i++)
+    {
+        joint_list_[i]->readPositionRad(joint_positions_rad_[i]);
+        joint_list_[i]->readVelocityRadSec(joint_velocities_rad_sec_[i]);
+        joint_list_[i]->readTorqueNm(joint_torques_nm_[i]);
+    }
+
+    joint_states_sequence_->endWrite();
+
+    CycleStamp stamp = cycle.getStamp();
+
+    for (size_t i = 0; i < joint_estimators_.size(); i++)
+    {
+        if (!joint_estimators_[i]) continue;
+
+        joint_estimators_[i]->update(stamp,
+                                     cycle.sample_time_sec,
+                                     joint_drives_[i]->readPositionRad(),
+                                     joint_drives_[i]->readVelocityRadSec(),
+                                     joint_drives_[i]->readAuxiliaryPositionRad());
+    }
+
+    if (cycle_controller_)
+    {
+        runCycleController(cycle);
+    }
+
+    updateJointGroups(cycle);
+
+    const SharedJointCommand* shared_commands = NULL;
+    size_t num_shared_commands = 0;
+
+    if (shared_commands_)
+    {
+        shared_commands = shared_commands_->arbitrate(time_sec);
+        num_shared_commands = std::min(joint_list_.size(), SHARED_STATE_MAX_JOINTS);
+    }
+
+    for (size_t i = 0; i < commandable_joints_.size(); i++)
+    {
+        JointActive* joint = commandable_joints_[i];
+
+        if (!joint) continue;
+
+        // an instantaneous command releases the joint from its group until the next commit,
+        // without the stop set point of a released joint
+        if (joint->takeGroupRelease())
+        {
+            group_command_modes_[i] = SharedCommandMode::NONE;
+            cyclic_command_modes_[i] = SharedCommandMode::NONE;
+        }
+
+        // shared commands take precedence over the controller, the controller over groups and
+        // groups over trajectories
+        SharedCommandMode mode = SharedCommandMode::NONE;
+        double value = 0.0;
+
+        if (i < num_shared_commands && shared_commands[i].mode != SharedCommandMode::NONE)
+        {
+            mode = shared_commands[i].mode;
+            value = shared_commands[i].value;
+        }
+        else if (cycle_controller_)
+        {
+            if (!std::isnan(controller_positions_rad_[i]))
+            {
+                mode = SharedCommandMode::POSITION;
+                value = controller_positions_rad_[i];
+            }
+            else if (!std::isnan(controller_velocities_rad_sec_[i]))
+            {
+                mode = SharedCommandMode::VELOCITY;
+                value = controller_velocities_rad_sec_[i];
+            }
+            else if (!std::isnan(controller_torques_nm_[i]))
+            {
+                mode = SharedCommandMode::TORQUE;
+                value = controller_torques_nm_[i];
+            }
+        }
+
+        if (mode == SharedCommandMode::NONE)
+        {
+            mode = group_command_modes_[i];
+            value = group_command_values_[i];
+        }
+
+        switch (mode)
+        {
+            case SharedCommandMode::POSITION:
+                joint->writeCyclicPositionRad(value, time_sec);
+                break;
+            case SharedCommandMode::VELOCITY:
+                joint->writeCyclicVelocityRadSec(value);
+                break;
+            case SharedCommandMode::TORQUE:
+                joint->writeCyclicTorqueNm(value);
+                break;
+            case SharedCommandMode::NONE:
+                // stop a joint that was released, a position set point holds
+                if (cyclic_command_modes_[i] == SharedCommandMode::VELOCITY)
+                    joint->writeCyclicVelocityRadSec(0.0);
+                else if (cyclic_command_modes_[i] == SharedCommandMode::TORQUE)
+                    joint->writeCyclicTorqueNm(0.0);
+
+                joint->updateTrajectory(time_sec);
+                break;
+        }
+
+        cyclic_command_modes_[i] = mode;
+
+        // holds for all set points, including those of commands sent long ago
+        joint->enforcePositionLimits();
+    }
+}
+
+void PlatformDriverEthercat::runCycleController(const CycleInfo& cycle)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::fill(controller_positions_rad_.begin(), controller_positions_rad_.end(), nan);
+    std::fill(controller_velocities_rad_sec_.begin(), controller_velocities_rad_sec_.end(), nan);
+    std::fill(controller_torques_nm_.begin(), controller_torques_nm_.end(), nan);
+
+    for (size_t i = 0; i < fts_list_.size(); i++)
+    {
+        controller_wrenches_[i] = fts_list_[i]->readWrench();
+    }
+
+    CycleControllerInput input{cycle.getStamp(),
+                               joint_list_.size(),
+                               joint_positions_rad_.data(),
+                               joint_velocities_rad_sec_.data(),
+                               joint_torques_nm_.data(),
+                               fts_list_.size(),
+                               controller_wrenches_.data()};
+    CycleControllerOutput output{joint_list_.size(),
+                                 controller_positions_rad_.data(),
+                                 controller_velocities_rad_sec_.data(),
+                                 controller_torques_nm_.data()};
+
+    cycle_controller_(input, output);
+}
+
+bool PlatformDriverEthercat::readFtsWrench(std::string fts_name, FtsSample& wrench)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    wrench = can_fts_.at(fts_name)->readWrench();
+
+    return true;
+}
+
+std::vector<std::string> PlatformDriverEthercat::getFtsNames()
+{
+    std::vector<std::string> names;
+
+    for (auto& fts : fts_list_)
+    {
+        names.push_back(fts->getDeviceName());
+    }
+
+    return names;
+}
+
+bool PlatformDriverEthercat::readFtsWrenches(FtsSample* wrenches, size_t num_wrenches)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    if (num_wrenches != fts_list_.size())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Number of wrenches and sensors differ");
+        return false;
+    }
+
+    for (size_t i = 0; i < num_wrenches; i++)
+    {
+        wrenches[i] = fts_list_[i]->readWrench();
+    }
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readFtsStatus(std::string fts_name, FtsStatus& status)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    status = can_fts_.at(fts_name)->readStatus();
+
+    return true;
+}
+
+bool PlatformDriverEthercat::setFtsStatusCallback(
+    std::string fts_name,
+    std::function<void(const FtsStatus& status)> callback)
+{
+    if (ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "EtherCAT interface already initialized");
+        return false;
+    }
+
+    CanDeviceAtiFts* fts = can_fts_.at(fts_name).get();
+    fts->setStatusCallback(std::move(callback));
+
+    // the cycle callbacks run after all devices were updated, also when workers update them
+    ethercat_->addCycleCallback([fts](const CycleInfo&) { fts->notifyStatus(); });
+
+    return true;
+}
+
+bool PlatformDriverEthercat::commandFtsFilter(std::string fts_name, unsigned int filter)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    return can_fts_.at(fts_name)->commandFilter(filter);
+}
+
+bool PlatformDriverEthercat::commandFtsBias(std::string fts_name)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    can_fts_.at(fts_name)->commandBias();
+
+    return true;
+}
+
+bool PlatformDriverEthercat::commandFtsClearBias(std::string fts_name)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    can_fts_.at(fts_name)->commandClearBias();
+
+    return true;
+}
+
+bool PlatformDriverEthercat::commandFtsToolTransform(std::string fts_name,
+                                                     double dx_m,
+                                                     double dy_m,
+                                                     double dz_m,
+                                                     double rx_rad,
+                                                     double ry_rad,
+                                                     double rz_rad)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    can_fts_.at(fts_name)->commandToolTransform(Eigen::Vector3d(dx_m, dy_m, dz_m),
+                                                Eigen::Vector3d(rx_rad, ry_rad, rz_rad));
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readFtsSamples(std::string fts_name, std::vector<FtsSample>& samples)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    can_fts_.at(fts_name)->readSamples(samples);
+
+    return true;
+}
+
+bool PlatformDriverEthercat::readFtsStreamStats(std::string fts_name, FtsStreamStats& stats)
+{
+    if (!ethercat_->isInit())
+    {
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, "Need to initialize EtherCAT interface first");
+        return false;
+    }
+
+    stats = can_fts_.at(fts_name)->readStreamStats();
+
+    return true;
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "PlatformDriverEthercatTypes.h"
@@ -14,7 +16,13 @@ class CanDriveTwitter;
 class EthercatInterface;
 class Joint;
 class JointActive;
+class JointEstimator;
 class JointPassive;
+class SequenceCounter;
+class SharedCommandServer;
+class SharedStateWriter;
+struct CycleInfo;
+enum class SharedCommandMode : uint32_t;
 
 /**
  * Represents and Controls all Drive components on an arbitrary platform.
@@ -34,8 +42,15 @@ class PlatformDriverEthercat
      */
     ~PlatformDriverEthercat();
 
+    /**
+     * Adds a drive, which is not added if its slave id is already used by another device.
+     */
     void addDriveTwitter(unsigned int slave_id, std::string name, DriveParams params);
 
+    /**
+     * Adds a force-torque sensor, which is not added if its slave id is already used by another
+     * device.
+     */
     void addAtiFts(unsigned int slave_id, std::string name);
 
     void addActiveJoint(std::string name,
@@ -45,6 +60,114 @@ class PlatformDriverEthercat
 
     void addPassiveJoint(std::string name, std::string drive, bool enabled);
 
+    void addPassiveJoint(std::string name,
+                         std::string drive,
+                         PassiveJointParams params,
+                         bool enabled);
+
+    /**
+     * Adds an object of a drive or sensor that is read over the mailbox in the background.
+     * The raw value is scaled and cached with the time of the read.
+     */
+    void addTelemetry(std::string device_name,
+                      std::string telemetry_name,
+                      uint16_t index,
+                      uint8_t subindex,
+                      TelemetryType type,
+                      double scale);
+
+    /**
+     * Adds DC link voltage (dc_link_voltage_v), drive temperature (drive_temp_deg_c) and error
+     * code (error_code) of a drive as telemetry.
+     */
+    void addDriveTelemetry(std::string drive_name);
+
+    /**
+     * Adds the diagnostic readings (diagnostic_reading_1 to 6) of a sensor as telemetry.
+     */
+    void addFtsTelemetry(std::string fts_name);
+
+    /**
+     * Sets the number of cycles between two mailbox transactions.
+     */
+    void setTelemetryPeriod(unsigned int cycles);
+
+    /**
+     * Publishes joint, drive and sensor states and cycle statistics to a POSIX shared memory
+     * segment in every EtherCAT cycle, so that other processes can read them with a
+     * SharedStateReader. Can only be enabled before initPlatform.
+     * @param shm_name Name of the segment, e.g. "/platform_state".
+     */
+    bool enableSharedState(std::string shm_name);
+
+    /**
+     * Accepts joint commands of other processes through a POSIX shared memory segment, see
+     * SharedCommandClient. Every cycle the command of the highest priority client is written to
+     * each joint as cyclic synchronous set point, taking precedence over trajectories. When a
+     * joint is released, velocity and torque are set to zero. Can only be enabled before
+     * initPlatform.
+     * @param shm_name Name of the segment, e.g. "/platform_commands".
+     * @param timeout_sec Age after which the commands of a client are ignored.
+     */
+    bool enableSharedCommands(std::string shm_name, double timeout_sec);
+
+    /**
+     * Sets a controller that is executed in every EtherCAT cycle right after the inputs were
+     * received. Its set points are sent in an additional frame right after the cycle callbacks,
+     * so the latency from the inputs to the set points is the processing time rather than a
+     * period, see EthercatInterface::enableEarlyOutputs. Set points are limited like cyclic
+     * commands and take precedence over trajectories, but not over shared commands.
+     * The controller must not block or allocate. Can only be set before initPlatform.
+     */
+    bool setCycleController(
+        std::function<void(const CycleControllerInput& input, CycleControllerOutput& output)>
+            controller);
+
+    /**
+     * Blocks until the EtherCAT cycle has processed the next frame, e.g. to run an application
+     * loop in phase with the bus.
+     * @param timeout_sec Maximum time to wait.
+     * @return False on timeout or if the interface is not initialized.
+     */
+    bool waitForNextCycle(double timeout_sec);
+
+    /**
+     * Creates an eventfd that becomes readable every given number of EtherCAT cycles, for
+     * executors built on epoll. Reading it returns the number of signals since the last read.
+     * Can only be enabled before initPlatform.
+     * @return File descriptor of the eventfd, owned by the platform, -1 on failure.
+     */
+    int enableCycleEvents(unsigned int cycles);
+
+    /**
+     * Updates the drives and sensors on a pool of worker threads in every EtherCAT cycle, for
+     * large topologies. Joint updates, controllers and other cycle callbacks still run on the
+     * cycle thread after all devices were updated. Can only be enabled before initPlatform.
+     * @param cpus CPU to pin each worker to, negative values leave a worker unpinned.
+     */
+    bool enableCycleWorkers(std::vector<int> cpus);
+
+    /**
+     * Sets the period of the EtherCAT cycle, 5 ms by default, in both the default and the
+     * pipelined cycle. Can only be set before initPlatform.
+     */
+    bool setCyclePeriod(double period_sec);
+
+    /**
+     * Sends the outputs of every EtherCAT cycle right after its inputs were processed and
+     * sleeps until the next deadline while the frame travels, instead of sending them with the
+     * next frame. The cycle no longer waits for the round trip of the frame and keeps its period
+     * when the processing time varies. It does not shorten the input to output latency, which
+     * stays about one period. Cycle stamps carry the time at which a frame was collected, about
+     * one period after its inputs were latched. Can only be enabled before initPlatform.
+     */
+    bool enablePipelinedCycle();
+
+    /**
+     * Gets the timing of the phases of the EtherCAT cycle, e.g. to compare the cycle modes.
+     */
+    bool readCyclePhaseStats(CyclePhaseStats& stats);
+
     /**
      * Initializes the ethercat interface and starts up the drives.
      * @return True if initialization is successful, false otherwise.
@@ -105,16 +228,358 @@ class PlatformDriverEthercat
 
     bool readJointTempDegC(std::string joint_name, double& temp_deg_c);
 
+    /**
+     * Resolves the name of a joint to a handle for the handle based commands and reads.
+     * @return False if there is no joint with the given name.
+     */
+    bool getJointHandle(const std::string& joint_name, JointHandle& joint);
+
+    /**
+     * Returns the names of all joints, the index of a name equals the index of its handle.
+     */
+    std::vector<std::string> getJointNames();
+
+    /**
+     * Sends position command for the joint with the given handle.
+     */
+    bool commandJointPositionRad(JointHandle joint, double position_rad);
+
+    /**
+     * Sends velocity command for the joint with the given handle.
+     */
+    bool commandJointVelocityRadSec(JointHandle joint, double velocity_rad_sec);
+
+    /**
+     * Sends torque command for the joint with the given handle.
+     */
+    bool commandJointTorqueNm(JointHandle joint, double torque_nm);
+
+    /**
+     * Gets the position of the joint with the given handle.
+     */
+    bool readJointPositionRad(JointHandle joint, double& position_rad);
+
+    /**
+     * Gets the velocity of the joint with the given handle.
+     */
+    bool readJointVelocityRadSec(JointHandle joint, double& velocity_rad_sec);
+
+    /**
+     * Gets the motor torque of the joint with the given handle.
+     */
+    bool readJointTorqueNm(JointHandle joint, double& torque_nm);
+
+    bool readJointTempDegC(JointHandle joint, double& temp_deg_c);
+
+    /**
+     * Returns the number of joints, i.e. the length of the arrays of the bulk commands and reads.
+     */
+    size_t getNumJoints();
+
+    /**
+     * Gets position, velocity and torque of all joints from the same EtherCAT cycle.
+     * Each array holds one element per joint in handle order, null arrays are skipped.
+     */
+    bool readJointStates(double* positions_rad, double* velocities_rad_sec, double* torques_nm);
+
+    /**
+     * Gets the joint states like readJointStates, together with the cycle that received them.
+     * The stamp tells when the states were received and whether all slaves processed the frame.
+     */
+    bool readJointStates(double* positions_rad,
+                         double* velocities_rad_sec,
+                         double* torques_nm,
+                         CycleStamp& stamp);
+
+    /**
+     * Gets position, velocity and torque of a given joint from the same EtherCAT cycle, together
+     * with the cycle that received them.
+     */
+    bool readJointState(std::string joint_name,
+                        double& position_rad,
+                        double& velocity_rad_sec,
+                        double& torque_nm,
+                        CycleStamp& stamp);
+
+    /**
+     * Gets position, velocity and torque of the joint with the given handle, see readJointState.
+     */
+    bool readJointState(JointHandle joint,
+                        double& position_rad,
+                        double& velocity_rad_sec,
+                        double& torque_nm,
+                        CycleStamp& stamp);
+
+    /**
+     * Fuses the motor encoder and the auxiliary output encoder of an active joint in a Kalman
+     * filter that runs in the EtherCAT cycle. Can only be enabled before initPlatform.
+     */
+    bool enableJointEstimator(std::string joint_name, JointEstimatorParams params);
+
+    /**
+     * Gets the estimated state of a given joint, predicted to the time of the call.
+     */
+    bool readJointEstimate(std::string joint_name, JointEstimate& estimate);
+
+    /**
+     * Gets the estimated state of the joint with the given handle, see readJointEstimate.
+     */
+    bool readJointEstimate(JointHandle joint, JointEstimate& estimate);
+
+    /**
+     * Sends position commands for all joints in one pass.
+     * The array holds one element per joint in handle order, NaN elements and passive or
+     * disabled joints are skipped. Limits are applied like for single commands, but not logged.
+     */
+    bool commandJointPositionsRad(const double* positions_rad);
+
+    /**
+     * Sends velocity commands for all joints in one pass, see commandJointPositionsRad.
+     */
+    bool commandJointVelocitiesRadSec(const double* velocities_rad_sec);
+
+    /**
+     * Sends torque commands for all joints in one pass, see commandJointPositionsRad.
+     */
+    bool commandJointTorquesNm(const double* torques_nm);
+
+    /**
+     * Adds a group of joints whose set points are staged and then committed together.
+     * The EtherCAT cycle writes all set points of a commit into the same frame.
+     * Groups can only be added before initPlatform, members must be enabled active joints.
+     */
+    bool addJointGroup(std::string group_name, std::vector<std::string> joint_names);
+
+    /**
+     * Stages a position set point for a member of a group, the index follows the order of the
+     * joint names passed to addJointGroup. Staged set points persist across commits, staging NaN
+     * releases the member.
+     */
+    bool stageJointGroupPositionRad(std::string group_name, size_t member, double position_rad);
+
+    /**
+     * Stages a velocity set point for a member of a group, see stageJointGroupPositionRad.
+     */
+    bool stageJointGroupVelocityRadSec(std::string group_name,
+                                       size_t member,
+                                       double velocity_rad_sec);
+
+    /**
+     * Stages a torque set point for a member of a group, see stageJointGroupPositionRad.
+     */
+    bool stageJointGroupTorqueNm(std::string group_name, size_t member, double torque_nm);
+
+    /**
+     * Hands the staged set points of a group over to the EtherCAT cycle as one transaction.
+     * The members follow their set points as cyclic synchronous commands, limited like cyclic
+     * commands and taking precedence over trajectories, until a later commit releases them.
+     * An instantaneous command to a member, e.g. commandJointPositionRad, releases that member
+     * like it cancels a trajectory, until the next commit of the group.
+     */
+    bool commitJointGroup(std::string group_name);
+
+    /**
+     * Gets the commit statistics of a group.
+     */
+    bool readJointGroupStats(std::string group_name, JointGroupStats& stats);
+
+    /**
+     * Sends a time-parameterized trajectory for specific joint.
+     * The trajectory starts immediately and is interpolated in every EtherCAT cycle, the
+     * resulting cyclic synchronous set points are limited like instantaneous commands.
+     */
+    bool commandJointTrajectory(std::string joint_name,
+                                std::vector<TrajectoryPoint> trajectory,
+                                TrajectoryMode mode);
+
+    /**
+     * Sends time-parameterized trajectories for a group of joints.
+     * All trajectories share the same start time.
+     */
+    bool commandJointsTrajectory(std::vector<std::string> joint_names,
+                                 std::vector<std::vector<TrajectoryPoint>> trajectories,
+                                 TrajectoryMode mode);
+
+    /**
+     * Checks if the trajectory of a given joint has passed its last waypoint.
+     */
+    bool isJointTrajectoryFinished(std::string joint_name);
+
+    /**
+     * Gets the cached value of a telemetry object without accessing the bus.
+     * @param value Last value read over the mailbox and the time of the read.
+     * @return False if the object was not read successfully yet.
+     */
+    bool readTelemetry(std::string device_name,
+                       std::string telemetry_name,
+                       TelemetryValue& value);
+
+    /**
+     * Gets the faults captured for a given drive, oldest first.
+     * Each record holds the CiA402 error code and the drive state of the preceding cycles.
+     */
+    bool readDriveFaultHistory(std::string drive_name, std::vector<DriveFaultRecord>& records);
+
     void readFtsForceN(std::string fts_name, double& fx, double& fy, double& fz);
 
     void readFtsTorqueNm(std::string fts_name, double& tx, double& ty, double& tz);
 
+    /**
+     * Gets force, torque, status and sample counter of a sensor from one consistent cycle.
+     */
+    bool readFtsWrench(std::string fts_name, FtsSample& wrench);
+
+    /**
+     * Returns the names of all sensors in the order used by readFtsWrenches.
+     */
+    std::vector<std::string> getFtsNames();
+
+    /**
+     * Gets the wrenches of all sensors in one call without name lookups.
+     * @param wrenches Array with one element per sensor, in the order of getFtsNames.
+     * @param num_wrenches Number of elements of the array.
+     */
+    bool readFtsWrenches(FtsSample* wrenches, size_t num_wrenches);
+
+    /**
+     * Gets the status flags and counters of a sensor decoded in the last cycle.
+     */
+    bool readFtsStatus(std::string fts_name, FtsStatus& status);
+
+    /**
+     * Sets a callback that is executed in the EtherCAT cycle whenever a status flag of a sensor
+     * changes. It runs on the cycle thread after all devices were updated, also when cycle
+     * workers are enabled, so it is never called concurrently. The callback must not block.
+     * Can only be set before initPlatform.
+     */
+    bool setFtsStatusCallback(std::string fts_name,
+                              std::function<void(const FtsStatus& status)> callback);
+
+    /**
+     * Selects the firmware low-pass filter of a sensor, 0 disables filtering.
+     */
+    bool commandFtsFilter(std::string fts_name, unsigned int filter);
+
+    /**
+     * Biases (tares) a sensor in firmware within the next cycle.
+     */
+    bool commandFtsBias(std::string fts_name);
+
+    /**
+     * Removes the firmware bias of a sensor within the next cycle.
+     */
+    bool commandFtsClearBias(std::string fts_name);
+
+    /**
+     * Sets the tool transformation that the sensor firmware applies to its readings.
+     */
+    bool commandFtsToolTransform(std::string fts_name,
+                                 double dx_m,
+                                 double dy_m,
+                                 double dz_m,
+                                 double rx_rad,
+                                 double ry_rad,
+                                 double rz_rad);
+
+    /**
+     * Gets every sample a sensor delivered since the last call.
+     * The samples are appended to the vector, which can be reused to avoid allocations.
+     */
+    bool readFtsSamples(std::string fts_name, std::vector<FtsSample>& samples);
+
+    /**
+     * Gets the statistics of the sample stream of a sensor.
+     */
+    bool readFtsStreamStats(std::string fts_name, FtsStreamStats& stats);
+
   private:
+    struct JointGroup;
+
+    void updateJoints(const CycleInfo& cycle);
+
+    /**
+     * Takes over new commits of the joint groups and updates their statistics.
+     */
+    void updateJointGroups(const CycleInfo& cycle);
+
+    bool stageJointGroupCommand(const std::string& group_name,
+                                size_t member,
+                                SharedCommandMode mode,
+                                double value);
+
+    /**
+     * Runs the cycle controller on the joint states of the current cycle.
+     */
+    void runCycleController(const CycleInfo& cycle);
+
+    /**
+     * Writes the names of all joints, drives and sensors to the shared state.
+     */
+    void initSharedState();
+
+    void publishSharedState(const CycleInfo& cycle);
+
+    void registerJoint(Joint* joint,
+                       JointActive* active_joint,
+                       CanDriveTwitter* drive,
+                       const ActiveJointParams* params);
+
+    /**
+     * Sends limited and sign corrected set points to the drives of the active joints.
+     */
+    void commandDrives(const double* commands, void (CanDriveTwitter::*command)(double));
+
     std::map<std::string, std::shared_ptr<CanDriveTwitter>> can_drives_;
+    std::vector<std::shared_ptr<CanDriveTwitter>> drive_list_;
     std::map<std::string, std::shared_ptr<CanDeviceAtiFts>> can_fts_;
+    std::vector<std::shared_ptr<CanDeviceAtiFts>> fts_list_;
     std::map<std::string, std::shared_ptr<Joint>> joints_;
     std::map<std::string, std::shared_ptr<JointActive>> active_joints_;
     std::map<std::string, std::shared_ptr<JointPassive>> passive_joints_;
+    std::vector<Joint*> joint_list_;  // indexed by joint handle
+
+    // joint data in handle order for bulk commands, unlimited bounds are infinite
+    std::vector<JointActive*> commandable_joints_;  // null for passive or disabled joints
+    std::vector<CanDriveTwitter*> joint_drives_;
+    std::vector<double> joint_signs_;
+    std::vector<double> joint_min_positions_rad_;
+    std::vector<double> joint_max_positions_rad_;
+    std::vector<double> joint_max_velocities_rad_sec_;
+    std::vector<double> joint_max_torques_nm_;
+    std::mutex bulk_command_mutex_;
+    std::vector<double> bulk_commands_;
+    std::vector<double> bulk_positions_rad_;
+
+    // joint states in handle order, published by the EtherCAT cycle
+    std::shared_ptr<SequenceCounter> joint_states_sequence_;
+    std::vector<double> joint_positions_rad_;
+    std::vector<double> joint_velocities_rad_sec_;
+    std::vector<double> joint_torques_nm_;
+    CycleStamp joint_states_stamp_;
+
+    // state estimators in handle order, null for joints without estimator
+    std::vector<std::shared_ptr<JointEstimator>> joint_estimators_;
+
+    std::map<std::pair<std::string, std::string>, int> telemetry_ids_;
+
+    std::shared_ptr<SharedStateWriter> shared_state_;
+
+    std::shared_ptr<SharedCommandServer> shared_commands_;
+
+    std::function<void(const CycleControllerInput&, CycleControllerOutput&)> cycle_controller_;
+    std::vector<double> controller_positions_rad_;
+    std::vector<double> controller_velocities_rad_sec_;
+    std::vector<double> controller_torques_nm_;
+    std::vector<FtsSample> controller_wrenches_;
+
+    std::vector<std::shared_ptr<JointGroup>> joint_groups_;
+    std::map<std::string, std::shared_ptr<JointGroup>> joint_groups_by_name_;
+    // set points of the last applied group commits in handle order, owned by the EtherCAT cycle
+    std::vector<SharedCommandMode> group_command_modes_;
+    std::vector<double> group_command_values_;
+
+    // cyclic set point type applied by shared commands, the controller or groups, in handle order
+    std::vector<SharedCommandMode> cyclic_command_modes_;
 
     std::shared_ptr<EthercatInterface> ethercat_;
 };
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace platform_driver_ethercat
 {
@@ -18,6 +21,7 @@ struct DriveParams
     bool encoder_on_output;
     double profile_velocity_rad_sec;
     double profile_acceleration_rad_sec_sec;
+    unsigned int auxiliary_encoder_increments = 0;  // single-turn resolution, 0 selects 4096
 };
 
 struct ActiveJointParams
@@ -29,4 +33,236 @@ struct ActiveJointParams
     double max_torque_command_nm;
     double temp_offset_deg_c;
 };
+
+struct PassiveJointParams
+{
+    double velocity_filter_alpha;  // position gain of the auxiliary velocity alpha-beta tracker
+    double velocity_filter_beta;   // velocity gain of the auxiliary velocity alpha-beta tracker
+};
+
+/**
+ * Noise model of the joint state estimator, standard deviations in joint units.
+ */
+struct JointEstimatorParams
+{
+    double acceleration_std_rad_sec_sec;  // unmodeled joint acceleration
+    double motor_position_std_rad;        // motor encoder position, scaled to the joint
+    double motor_velocity_std_rad_sec;    // motor encoder velocity, scaled to the joint
+    double output_position_std_rad;       // auxiliary encoder on the joint output
+    double backlash_rad;                  // play of the gear between motor and output
+};
+
+/**
+ * Index of a joint, resolved once by name to command and read the joint without lookups.
+ */
+struct JointHandle
+{
+    uint16_t index;
+};
+
+/**
+ * Identifies the EtherCAT cycle that received a state.
+ * In the pipelined cycle time_sec is the time at which the frame was collected, about one
+ * period after the slaves latched its inputs.
+ */
+struct CycleStamp
+{
+    uint64_t sequence;   // number of cycles since the interface was initialized
+    double time_sec;     // monotonic time at which the process data was received
+    bool valid;          // all slaves processed the frame, i.e. the working counter was complete
+    int64_t dc_time_ns;  // distributed clock time of the frame, 0 if no slave supports it
+};
+
+/**
+ * Joint state estimated from motor and output encoders.
+ */
+struct JointEstimate
+{
+    CycleStamp stamp;         // cycle of the last fused measurements
+    double time_sec;          // monotonic time the estimate was predicted to
+    double position_rad;      // output position
+    double velocity_rad_sec;  // output velocity
+    double deflection_rad;    // output position minus motor position, includes backlash
+    bool valid;               // false until the estimator received measurements
+};
+
+/**
+ * Drive state recorded in one process data cycle.
+ */
+struct DriveSample
+{
+    double time_sec;
+    uint16_t status_word;
+    double position_rad;
+    double velocity_rad_sec;
+    double torque_nm;
+};
+
+/**
+ * Drive state captured on a transition into a fault state.
+ */
+struct DriveFaultRecord
+{
+    double time_sec;
+    uint16_t status_word;
+    uint16_t error_code;               // CiA402 error code (0x603f)
+    bool error_code_valid;             // false if the error code could not be read
+    std::vector<DriveSample> history;  // preceding cycles, oldest first, ending with the fault
+};
+
+/**
+ * Force-torque sample of a sensor.
+ */
+struct FtsSample
+{
+    CycleStamp stamp;       // cycle that received the sample
+    uint32_t sample_count;  // sample counter of the sensor
+    uint32_t status_code;
+    double fx;
+    double fy;
+    double fz;
+    double tx;
+    double ty;
+    double tz;
+};
+
+/**
+ * Statistics of the force-torque sample stream of a sensor.
+ */
+struct FtsStreamStats
+{
+    uint64_t samples;          // samples received
+    uint64_t missed_samples;   // gaps in the sample counter, samples the bus never delivered
+    uint64_t dropped_samples;  // samples lost because the stream was not read in time
+};
+
+/**
+ * Status of a force-torque sensor decoded in the process data cycle.
+ */
+struct FtsStatus
+{
+    uint32_t status_code;      // raw status code of the last cycle
+    bool error;                // summary error bit of the sensor
+    bool saturated;            // a strain gauge is saturated
+    bool gauge_fault;          // analog front end out of range
+    bool supply_fault;         // supply voltage out of range
+    bool calibration_fault;    // calibration or configuration invalid
+    bool stale;                // the sample counter stopped advancing
+    uint64_t num_errors;       // number of transitions into error
+    uint64_t num_saturations;  // number of transitions into saturation
+    uint64_t num_stale;        // number of transitions into stale data
+};
+
+/**
+ * Statistics of the commits of a joint group.
+ * Latency is measured from the commit to the transmission of the frame carrying its set points.
+ */
+struct JointGroupStats
+{
+    uint64_t commits;             // commits of the application
+    uint64_t applied_commits;     // commits written to the drives
+    uint64_t superseded_commits;  // commits replaced by a newer commit before they were applied
+    double last_latency_sec;
+    double mean_latency_sec;
+    double max_latency_sec;
+};
+
+/**
+ * Durations of one phase of the EtherCAT cycle.
+ */
+struct CyclePhase
+{
+    uint64_t samples;
+    double last_sec;
+    double mean_sec;
+    double max_sec;
+};
+
+/**
+ * Timing of the phases of the EtherCAT cycle.
+ * The latency is measured from the estimated time at which the slaves latched the inputs until
+ * the frame carrying the outputs computed from them was sent. It is about one period in both
+ * cycle modes.
+ */
+struct CyclePhaseStats
+{
+    uint64_t cycles;
+    uint64_t overruns;   // cycles that started after their deadline, pipelined cycle only
+    CyclePhase receive;  // waiting for the frame and copying the inputs
+    CyclePhase process;  // device updates and cycle callbacks
+    CyclePhase send;     // copying the outputs and handing the frame to the network
+    CyclePhase latency;  // input to output latency
+    CyclePhase period;   // time between the starts of consecutive cycles
+};
+
+/**
+ * Inputs of one EtherCAT cycle passed to the cycle controller.
+ * Joint arrays are in handle order, wrenches in the order of getFtsNames.
+ */
+struct CycleControllerInput
+{
+    CycleStamp stamp;
+    size_t num_joints;
+    const double* positions_rad;
+    const double* velocities_rad_sec;
+    const double* torques_nm;
+    size_t num_fts;
+    const FtsSample* wrenches;
+};
+
+/**
+ * Set points written by the cycle controller, arrays in joint handle order.
+ * All elements are NaN when the controller is called. A joint takes the first element that is
+ * set, in the order position, velocity, torque, and otherwise keeps following its trajectory.
+ */
+struct CycleControllerOutput
+{
+    size_t num_joints;
+    double* positions_rad;
+    double* velocities_rad_sec;
+    double* torques_nm;
+};
+
+/**
+ * Data type of an object read as telemetry.
+ */
+enum class TelemetryType
+{
+    INT16,
+    UINT16,
+    INT32,
+    UINT32
+};
+
+/**
+ * Cached telemetry value.
+ */
+struct TelemetryValue
+{
+    double value;     // scaled value of the last successful read
+    double time_sec;  // monotonic time of the last successful read
+    bool valid;       // false until the object was read successfully
+};
+
+/**
+ * Waypoint of a time-parameterized joint trajectory.
+ * Time is relative to the start of the trajectory.
+ */
+struct TrajectoryPoint
+{
+    double time_sec;
+    double position_rad;
+    double velocity_rad_sec;
+    double acceleration_rad_sec_sec;
+};
+
+/**
+ * Set point that is written to the drive while a trajectory is executed, either cyclic
+ * synchronous position (CSP) or cyclic synchronous velocity (CSV).
+ */
+enum class TrajectoryMode
+{
+    POSITION,
+    VELOCITY
+};
 }
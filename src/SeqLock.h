@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace platform_driver_ethercat
+{
+
+/**
+ * Sequence counter for data with exactly one writer thread.
+ * The writer never blocks, readers retry until they copied the data without a concurrent write.
+ * Can protect data that does not fit into a SeqLock, e.g. arrays sized at runtime.
+ */
+class SequenceCounter
+{
+  public:
+    SequenceCounter() : sequence_(0) {}
+
+    /**
+     * Marks the start of a write, called from the writer thread only.
+     */
+    void beginWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * Marks the end of a write, called from the writer thread only.
+     */
+    void endWrite()
+    {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Marks the start of a read.
+     * @return Sequence to pass to retryRead.
+     */
+    uint32_t beginRead() const
+    {
+        uint32_t sequence;
+
+        do
+        {
+            sequence = sequence_.load(std::memory_order_acquire);
+        } while (sequence & 1);
+
+        return sequence;
+    }
+
+    /**
+     * Marks the start of a read without waiting for a write in progress.
+     * @param sequence Sequence to pass to retryRead.
+     * @return False if a write is in progress.
+     */
+    bool tryBeginRead(uint32_t& sequence) const
+    {
+        sequence = sequence_.load(std::memory_order_acquire);
+
+        return !(sequence & 1);
+    }
+
+    /**
+     * Checks if the data was written while it was read.
+     * @return True if the read has to be repeated.
+     */
+    bool retryRead(uint32_t sequence) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        return sequence_.load(std::memory_order_relaxed) != sequence;
+    }
+
+  private:
+    std::atomic<uint32_t> sequence_;  // odd while a write is in progress
+};
+
+/**
+ * Sequence lock for a trivially copyable value with exactly one writer thread.
+ * The writer never blocks, readers retry until they copied a consistent value.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "SeqLock requires a trivially copyable type");
+
+  public:
+    SeqLock() : value_() {}
+
+    /**
+     * Publishes a new value, called from the writer thread only.
+     */
+    void write(const T& value)
+    {
+        sequence_.beginWrite();
+        value_ = value;
+        sequence_.endWrite();
+    }
+
+    /**
+     * Copies the last published value.
+     */
+    T read() const
+    {
+        T value;
+        uint32_t sequence;
+
+        do
+        {
+            sequence = sequence_.beginRead();
+            value = value_;
+        } while (sequence_.retryRead(sequence));
+
+        return value;
+    }
+
+  private:
+    SequenceCounter sequence_;
+    T value_;
+};
+}
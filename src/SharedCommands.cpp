@@ -0,0 +1,279 @@
+#include <signal.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+#include "SharedCommands.h"
+#include "SharedMemory.h"
+
+#include "Logging.hpp"
+#include <sstream>
+static std::stringstream ss;
+
+using namespace platform_driver_ethercat;
+
+SharedCommandServer::SharedCommandServer() : timeout_sec_(0.0), segment_(NULL)
+{
+    std::fill(slot_owners_, slot_owners_ + SHARED_COMMANDS_MAX_CLIENTS, 0);
+}
+
+SharedCommandServer::~SharedCommandServer()
+{
+    if (segment_)
+    {
+        unmapSharedMemory(segment_, sizeof(SharedCommandSegment));
+        shm_unlink(name_.c_str());
+    }
+}
+
+bool SharedCommandServer::open(const std::string& name, double timeout_sec)
+{
+    void* memory = mapSharedMemory(name, sizeof(SharedCommandSegment), true, true);
+
+    if (!memory) return false;
+
+    segment_ = new (memory) SharedCommandSegment();
+
+    for (size_t i = 0; i < SHARED_STATE_MAX_JOINTS; i++)
+    {
+        segment_->joint_owners[i].store(-1, std::memory_order_relaxed);
+    }
+
+    name_ = name;
+    timeout_sec_ = timeout_sec;
+
+    return true;
+}
+
+void SharedCommandServer::setJointNames(const std::vector<std::string>& joint_names)
+{
+    segment_->num_joints = std::min(joint_names.size(), SHARED_STATE_MAX_JOINTS);
+
+    for (size_t i = 0; i < segment_->num_joints; i++)
+    {
+        strncpy(segment_->joint_names[i], joint_names[i].c_str(), SHARED_STATE_NAME_LENGTH - 1);
+    }
+
+    if (segment_->num_joints < joint_names.size())
+    {
+        log(LogLevel::WARN, __PRETTY_FUNCTION__, "Too many joints, shared commands are truncated");
+    }
+
+    // clients check the header, so it is written last
+    segment_->size = sizeof(SharedCommandSegment);
+    segment_->version = SHARED_COMMANDS_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    segment_->magic = SHARED_COMMANDS_MAGIC;
+}
+
+bool SharedCommandServer::readSlot(size_t s)
+{
+    const SharedCommandSlot& slot = segment_->slots[s];
+    uint32_t sequence;
+
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        if (!slot.sequence.tryBeginRead(sequence)) continue;
+
+        std::memcpy(&slot_read_, &slot.commands, sizeof(SharedCommandSet));
+
+        if (slot.sequence.retryRead(sequence)) continue;
+
+        std::memcpy(&slot_commands_[s], &slot_read_, sizeof(SharedCommandSet));
+        return true;
+    }
+
+    return false;
+}
+
+const SharedJointCommand* SharedCommandServer::arbitrate(double time_sec)
+{
+    uint32_t num_joints = segment_->num_joints;
+
+    for (uint32_t i = 0; i < num_joints; i++)
+    {
+        joint_commands_[i].mode = SharedCommandMode::NONE;
+        joint_owners_[i] = -1;
+    }
+
+    for (size_t s = 0; s < SHARED_COMMANDS_MAX_CLIENTS; s++)
+    {
+        pid_t owner = segment_->slots[s].owner.load(std::memory_order_acquire);
+
+        // a client that is writing keeps its last consistent commands until they time out,
+        // a new client is ignored until its commands were read once
+        if (owner != 0 && !readSlot(s) && owner != slot_owners_[s]) owner = 0;
+
+        slot_owners_[s] = owner;
+
+        if (owner == 0) continue;
+
+        const SharedCommandSet& commands = slot_commands_[s];
+
+        if (!(time_sec - commands.time_sec <= timeout_sec_)) continue;
+
+        for (uint32_t i = 0; i < num_joints; i++)
+        {
+            const SharedJointCommand& command = commands.joints[i];
+
+            if (command.mode == SharedCommandMode::NONE || !std::isfinite(command.value))
+                continue;
+
+            if (joint_owners_[i] < 0 || commands.priority > joint_priorities_[i])
+            {
+                joint_commands_[i] = command;
+                joint_priorities_[i] = commands.priority;
+                joint_owners_[i] = s;
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < num_joints; i++)
+    {
+        segment_->joint_owners[i].store(joint_owners_[i], std::memory_order_relaxed);
+    }
+
+    return joint_commands_;
+}
+
+SharedCommandClient::SharedCommandClient()
+    : segment_(NULL), slot_(NULL), slot_id_(-1), priority_(0)
+{
+}
+
+SharedCommandClient::~SharedCommandClient() { close(); }
+
+bool SharedCommandClient::open(const std::string& name, uint32_t priority)
+{
+    close();
+
+    SharedCommandSegment* segment = static_cast<SharedCommandSegment*>(
+        mapSharedMemory(name, sizeof(SharedCommandSegment), false, true));
+
+    if (!segment) return false;
+
+    bool valid = segment->magic == SHARED_COMMANDS_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    if (!valid || segment->version != SHARED_COMMANDS_VERSION
+        || segment->size != sizeof(SharedCommandSegment))
+    {
+        ss << "Shared memory segment " << name << " is not ready or has a different layout";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        unmapSharedMemory(segment, sizeof(SharedCommandSegment));
+        return false;
+    }
+
+    pid_t pid = getpid();
+
+    for (size_t s = 0; s < SHARED_COMMANDS_MAX_CLIENTS; s++)
+    {
+        SharedCommandSlot& slot = segment->slots[s];
+        pid_t owner = slot.owner.load(std::memory_order_acquire);
+
+        // take over slots of processes that exited without releasing them
+        if (owner != 0 && !(kill(owner, 0) != 0 && errno == ESRCH)) continue;
+
+        if (!slot.owner.compare_exchange_strong(owner, pid, std::memory_order_acq_rel)) continue;
+
+        // a previous owner might have died while writing
+        uint32_t sequence;
+        if (!slot.sequence.tryBeginRead(sequence))
+        {
+            slot.sequence.endWrite();
+        }
+
+        segment_ = segment;
+        slot_ = &slot;
+        slot_id_ = s;
+        priority_ = priority;
+
+        // drop the commands of the previous owner
+        slot_->sequence.beginWrite();
+        slot_->commands.priority = priority_;
+        slot_->commands.time_sec = 0.0;
+        for (size_t i = 0; i < SHARED_STATE_MAX_JOINTS; i++)
+        {
+            slot_->commands.joints[i].mode = SharedCommandMode::NONE;
+        }
+        slot_->sequence.endWrite();
+
+        return true;
+    }
+
+    ss << "All slots of shared memory segment " << name << " are taken";
+    log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+    ss.str(""); ss.clear();
+    unmapSharedMemory(segment, sizeof(SharedCommandSegment));
+
+    return false;
+}
+
+void SharedCommandClient::close()
+{
+    if (!segment_) return;
+
+    slot_->sequence.beginWrite();
+    for (size_t i = 0; i < SHARED_STATE_MAX_JOINTS; i++)
+    {
+        slot_->commands.joints[i].mode = SharedCommandMode::NONE;
+    }
+    slot_->sequence.endWrite();
+
+    slot_->owner.store(0, std::memory_order_release);
+
+    unmapSharedMemory(segment_, sizeof(SharedCommandSegment));
+    segment_ = NULL;
+    slot_ = NULL;
+    slot_id_ = -1;
+}
+
+size_t SharedCommandClient::getNumJoints() const
+{
+    return segment_ ? segment_->num_joints : 0;
+}
+
+bool SharedCommandClient::getJointIndex(const std::string& joint_name, size_t& index) const
+{
+    for (size_t i = 0; i < getNumJoints(); i++)
+    {
+        if (joint_name == segment_->joint_names[i])
+        {
+            index = i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SharedCommandClient::command(const SharedJointCommand* commands)
+{
+    if (!segment_) return false;
+
+    // same clock as the EtherCAT cycle
+    double time_sec = std::chrono::duration<double>(
+                          std::chrono::steady_clock::now().time_since_epoch())
+                          .count();
+
+    slot_->sequence.beginWrite();
+    slot_->commands.priority = priority_;
+    slot_->commands.time_sec = time_sec;
+    std::memcpy(slot_->commands.joints, commands, getNumJoints() * sizeof(SharedJointCommand));
+    slot_->sequence.endWrite();
+
+    return true;
+}
+
+bool SharedCommandClient::isJointOwner(size_t index) const
+{
+    if (!segment_ || index >= getNumJoints()) return false;
+
+    return segment_->joint_owners[index].load(std::memory_order_relaxed) == slot_id_;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "SeqLock.h"
+#include "SharedState.h"
+
+namespace platform_driver_ethercat
+{
+
+// identifies a command segment and its layout
+const uint32_t SHARED_COMMANDS_MAGIC = 0x50444543;
+const uint32_t SHARED_COMMANDS_VERSION = 1;
+
+const size_t SHARED_COMMANDS_MAX_CLIENTS = 8;
+
+/**
+ * Cyclic synchronous set point type of a shared joint command.
+ */
+enum class SharedCommandMode : uint32_t
+{
+    NONE,  // the client does not command the joint
+    POSITION,
+    VELOCITY,
+    TORQUE
+};
+
+struct SharedJointCommand
+{
+    SharedCommandMode mode;
+    double value;  // rad, rad/s or Nm, depending on the mode
+};
+
+/**
+ * Commands of one client for all joints, in joint handle order.
+ */
+struct SharedCommandSet
+{
+    uint32_t priority;  // a higher priority overrides the commands of other clients
+    double time_sec;    // monotonic time at which the commands were written
+    SharedJointCommand joints[SHARED_STATE_MAX_JOINTS];
+};
+
+/**
+ * Command slot written by exactly one client.
+ */
+struct SharedCommandSlot
+{
+    std::atomic<pid_t> owner;  // process that claimed the slot, 0 if free
+    SequenceCounter sequence;
+    SharedCommandSet commands;
+};
+
+/**
+ * Memory layout of the command segment.
+ */
+struct SharedCommandSegment
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t num_joints;
+    char joint_names[SHARED_STATE_MAX_JOINTS][SHARED_STATE_NAME_LENGTH];
+
+    // slot of the client that owns each joint, -1 if none, written by the server every cycle
+    std::atomic<int32_t> joint_owners[SHARED_STATE_MAX_JOINTS];
+
+    SharedCommandSlot slots[SHARED_COMMANDS_MAX_CLIENTS];
+};
+
+/**
+ * Creates the command segment and arbitrates the client commands in the EtherCAT cycle.
+ * For every joint the command of the client with the highest priority wins, ties go to the
+ * lower slot. Commands that were not refreshed within the timeout are ignored.
+ */
+class SharedCommandServer
+{
+  public:
+    SharedCommandServer();
+    ~SharedCommandServer();
+
+    /**
+     * Creates or replaces the segment with the given name, e.g. "/platform_commands".
+     * Clients can only connect after setJointNames.
+     * @param timeout_sec Age after which the commands of a client are ignored.
+     */
+    bool open(const std::string& name, double timeout_sec);
+
+    /**
+     * Sets the joints in handle order and accepts clients.
+     */
+    void setJointNames(const std::vector<std::string>& joint_names);
+
+    /**
+     * Selects the command of every joint and publishes the joint owners.
+     * Called from the EtherCAT cycle only.
+     * @return Selected commands in joint order, mode NONE if no client commands the joint.
+     */
+    const SharedJointCommand* arbitrate(double time_sec);
+
+  private:
+    std::string name_;
+    double timeout_sec_;
+    SharedCommandSegment* segment_;
+
+    // owned by the EtherCAT cycle
+    SharedCommandSet slot_read_;
+
+    // last consistent commands of every slot, reused while a client is writing
+    SharedCommandSet slot_commands_[SHARED_COMMANDS_MAX_CLIENTS];
+    pid_t slot_owners_[SHARED_COMMANDS_MAX_CLIENTS];
+    SharedJointCommand joint_commands_[SHARED_STATE_MAX_JOINTS];
+    uint32_t joint_priorities_[SHARED_STATE_MAX_JOINTS];
+    int32_t joint_owners_[SHARED_STATE_MAX_JOINTS];
+
+    /**
+     * Updates the copy of the commands of a slot without waiting for a client that is writing
+     * or died while writing.
+     * @return False if the copy is unchanged because no consistent read succeeded.
+     */
+    bool readSlot(size_t s);
+};
+
+/**
+ * Commands joints through the segment of a SharedCommandServer, possibly from another process.
+ * Each client claims one slot, commands never block and never enter the kernel.
+ */
+class SharedCommandClient
+{
+  public:
+    SharedCommandClient();
+    ~SharedCommandClient();
+
+    /**
+     * Maps the segment with the given name and claims a free slot.
+     * A slot of a process that no longer exists is considered free.
+     * @param priority Priority of the commands of this client.
+     * @return False if the segment is not available or all slots are taken.
+     */
+    bool open(const std::string& name, uint32_t priority);
+
+    /**
+     * Releases the slot, the commands of this client are dropped.
+     */
+    void close();
+
+    size_t getNumJoints() const;
+
+    /**
+     * Resolves the name of a joint to its index in the command array.
+     */
+    bool getJointIndex(const std::string& joint_name, size_t& index) const;
+
+    /**
+     * Publishes commands for all joints, mode NONE leaves a joint to other clients.
+     * The commands must be refreshed within the timeout of the server.
+     * @param commands Array with one element per joint, see getNumJoints.
+     */
+    bool command(const SharedJointCommand* commands);
+
+    /**
+     * Checks if the commands of this client were selected for a joint in the last cycle.
+     */
+    bool isJointOwner(size_t index) const;
+
+  private:
+    SharedCommandSegment* segment_;
+    SharedCommandSlot* slot_;
+    int32_t slot_id_;
+    uint32_t priority_;
+};
+}
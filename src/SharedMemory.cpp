@@ -0,0 +1,69 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#include "SharedMemory.h"
+
+#include "Logging.hpp"
+#include <sstream>
+static std::stringstream ss;
+
+using namespace platform_driver_ethercat;
+
+void* platform_driver_ethercat::mapSharedMemory(const std::string& name,
+                                                size_t size,
+                                                bool create,
+                                                bool writable)
+{
+    int flags = writable ? O_RDWR : O_RDONLY;
+    int fd = shm_open(name.c_str(), create ? flags | O_CREAT : flags, 0664);
+
+    if (fd < 0)
+    {
+        ss << "Cannot open shared memory segment " << name << ": " << strerror(errno);
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return NULL;
+    }
+
+    struct stat info;
+
+    if (create && ftruncate(fd, size) != 0)
+    {
+        ss << "Cannot resize shared memory segment " << name << ": " << strerror(errno);
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        close(fd);
+        return NULL;
+    }
+    else if (!create && (fstat(fd, &info) != 0 || info.st_size != (off_t)size))
+    {
+        ss << "Shared memory segment " << name << " has a different layout";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        close(fd);
+        return NULL;
+    }
+
+    int protection = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* memory = mmap(NULL, size, protection, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (memory == MAP_FAILED)
+    {
+        ss << "Cannot map shared memory segment " << name << ": " << strerror(errno);
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        return NULL;
+    }
+
+    return memory;
+}
+
+void platform_driver_ethercat::unmapSharedMemory(const void* memory, size_t size)
+{
+    munmap(const_cast<void*>(memory), size);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace platform_driver_ethercat
+{
+
+/**
+ * Maps a POSIX shared memory segment, errors are logged.
+ * @param name Name of the segment, e.g. "/platform_state".
+ * @param size Size of the segment, an existing segment must have exactly this size.
+ * @param create Creates the segment, or resizes an existing one, with read access for others.
+ * @param writable Maps the segment for writing.
+ * @return Address of the mapping, NULL on failure.
+ */
+void* mapSharedMemory(const std::string& name, size_t size, bool create, bool writable);
+
+/**
+ * Unmaps a segment mapped by mapSharedMemory.
+ */
+void unmapSharedMemory(const void* memory, size_t size);
+}
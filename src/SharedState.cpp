@@ -0,0 +1,105 @@
+#include <sys/mman.h>
+#include <cstring>
+#include <new>
+
+#include "SharedMemory.h"
+#include "SharedState.h"
+
+#include "Logging.hpp"
+#include <sstream>
+static std::stringstream ss;
+
+using namespace platform_driver_ethercat;
+
+SharedStateWriter::SharedStateWriter() : segment_(NULL) {}
+
+SharedStateWriter::~SharedStateWriter()
+{
+    if (segment_)
+    {
+        unmapSharedMemory(segment_, sizeof(SharedStateSegment));
+        shm_unlink(name_.c_str());
+    }
+}
+
+bool SharedStateWriter::open(const std::string& name)
+{
+    void* memory = mapSharedMemory(name, sizeof(SharedStateSegment), true, true);
+
+    if (!memory) return false;
+
+    // readers check the header, so it is written last
+    segment_ = new (memory) SharedStateSegment();
+    segment_->size = sizeof(SharedStateSegment);
+    segment_->version = SHARED_STATE_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    segment_->magic = SHARED_STATE_MAGIC;
+    name_ = name;
+
+    return true;
+}
+
+SharedState& SharedStateWriter::beginWrite()
+{
+    segment_->sequence.beginWrite();
+
+    return segment_->state;
+}
+
+void SharedStateWriter::endWrite() { segment_->sequence.endWrite(); }
+
+SharedStateReader::SharedStateReader() : segment_(NULL) {}
+
+SharedStateReader::~SharedStateReader()
+{
+    if (segment_)
+    {
+        unmapSharedMemory(segment_, sizeof(SharedStateSegment));
+    }
+}
+
+bool SharedStateReader::open(const std::string& name)
+{
+    const SharedStateSegment* segment = static_cast<const SharedStateSegment*>(
+        mapSharedMemory(name, sizeof(SharedStateSegment), false, false));
+
+    if (!segment) return false;
+
+    if (segment->magic != SHARED_STATE_MAGIC || segment->version != SHARED_STATE_VERSION
+        || segment->size != sizeof(SharedStateSegment))
+    {
+        ss << "Shared memory segment " << name << " has a different layout";
+        log(LogLevel::ERROR, __PRETTY_FUNCTION__, ss.str());
+        ss.str(""); ss.clear();
+        unmapSharedMemory(segment, sizeof(SharedStateSegment));
+        return false;
+    }
+
+    if (segment_)
+    {
+        unmapSharedMemory(segment_, sizeof(SharedStateSegment));
+    }
+
+    segment_ = segment;
+
+    return true;
+}
+
+bool SharedStateReader::read(SharedState& state) const
+{
+    if (!segment_) return false;
+
+    uint32_t sequence;
+
+    // bounded, a writer that died in the middle of a write never finishes it
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        if (!segment_->sequence.tryBeginRead(sequence)) continue;
+
+        std::memcpy(&state, &segment_->state, sizeof(SharedState));
+
+        if (!segment_->sequence.retryRead(sequence)) return sequence != 0;
+    }
+
+    return false;
+}
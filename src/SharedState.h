@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "PlatformDriverEthercatTypes.h"
+#include "SeqLock.h"
+
+namespace platform_driver_ethercat
+{
+
+// identifies a platform state segment and its layout
+const uint32_t SHARED_STATE_MAGIC = 0x50444553;
+const uint32_t SHARED_STATE_VERSION = 2;
+
+const size_t SHARED_STATE_MAX_JOINTS = 64;
+const size_t SHARED_STATE_MAX_DRIVES = 64;
+const size_t SHARED_STATE_MAX_FTS = 16;
+const size_t SHARED_STATE_NAME_LENGTH = 32;
+
+/**
+ * Statistics of the EtherCAT cycle that produced a shared state.
+ */
+struct SharedCycleState
+{
+    uint64_t sequence;               // number of cycles since the interface was initialized
+    double time_sec;                 // monotonic time at which the process data was received
+    int32_t wkc;                     // working counter of the received frame
+    int32_t expected_wkc;            // working counter of a frame that all slaves processed
+    int64_t dc_time_ns;              // distributed clock time of the frame, 0 if not available
+    uint64_t num_incomplete_frames;  // frames with a working counter below the expected one
+};
+
+struct SharedJointState
+{
+    char name[SHARED_STATE_NAME_LENGTH];
+    double position_rad;
+    double velocity_rad_sec;
+    double torque_nm;
+};
+
+struct SharedDriveState
+{
+    char name[SHARED_STATE_NAME_LENGTH];
+    uint16_t status_word;  // CiA402 status word
+    bool fault;            // fault bit of the status word
+};
+
+struct SharedFtsState
+{
+    char name[SHARED_STATE_NAME_LENGTH];
+    FtsSample wrench;
+};
+
+/**
+ * Platform state published once per EtherCAT cycle.
+ * Joints are in handle order, sensors in the order of getFtsNames.
+ */
+struct SharedState
+{
+    SharedCycleState cycle;
+    uint32_t num_joints;
+    uint32_t num_drives;
+    uint32_t num_fts;
+    SharedJointState joints[SHARED_STATE_MAX_JOINTS];
+    SharedDriveState drives[SHARED_STATE_MAX_DRIVES];
+    SharedFtsState fts[SHARED_STATE_MAX_FTS];
+};
+
+static_assert(std::is_trivially_copyable<SharedState>::value,
+              "SharedState must be trivially copyable");
+
+/**
+ * Memory layout of the shared memory segment.
+ */
+struct SharedStateSegment
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;  // size of the segment, guards against readers built with other limits
+    SequenceCounter sequence;
+    SharedState state;
+};
+
+/**
+ * Creates a POSIX shared memory segment and publishes platform states into it.
+ * Used by the EtherCAT cycle, which is the only writer.
+ */
+class SharedStateWriter
+{
+  public:
+    SharedStateWriter();
+    ~SharedStateWriter();
+
+    /**
+     * Creates or replaces the segment with the given name, e.g. "/platform_state".
+     * @return False if the segment could not be created.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Starts an update, the returned state keeps the contents of the previous update.
+     */
+    SharedState& beginWrite();
+
+    /**
+     * Publishes the update to the readers.
+     */
+    void endWrite();
+
+  private:
+    std::string name_;
+    SharedStateSegment* segment_;
+};
+
+/**
+ * Maps the segment of a SharedStateWriter, possibly in another process.
+ * Reads copy the state directly from the mapping without system calls.
+ */
+class SharedStateReader
+{
+  public:
+    SharedStateReader();
+    ~SharedStateReader();
+
+    /**
+     * Maps the segment with the given name read-only.
+     * @return False if the segment does not exist or has a different layout.
+     */
+    bool open(const std::string& name);
+
+    /**
+     * Copies the last published state.
+     * @return False if no segment is mapped, nothing was published yet or no consistent copy
+     * was made, e.g. because the driver died while it was writing.
+     */
+    bool read(SharedState& state) const;
+
+  private:
+    const SharedStateSegment* segment_;
+};
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace platform_driver_ethercat
+{
+
+/**
+ * Fixed-capacity lock-free queue for exactly one producer and one consumer thread.
+ * Neither side blocks or allocates, a full queue rejects new items.
+ */
+template <typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+
+  public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    /**
+     * Appends an item, called from the producer thread only.
+     * @return False if the queue is full.
+     */
+    bool push(const T& item)
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+
+        if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+
+        buffer_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * Removes the oldest item, called from the consumer thread only.
+     * @return False if the queue is empty.
+     */
+    bool pop(T& item)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+
+        item = buffer_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /**
+     * Returns the number of queued items, exact only when called from producer or consumer.
+     */
+    size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+  private:
+    T buffer_[Capacity];
+    std::atomic<size_t> head_;  // next item to pop, written by the consumer
+    std::atomic<size_t> tail_;  // next slot to push, written by the producer
+};
+}
@@ -0,0 +1,82 @@
+#include <algorithm>
+
+#include "Trajectory.h"
+
+using namespace platform_driver_ethercat;
+
+Trajectory::Trajectory(std::vector<TrajectoryPoint> points,
+                       TrajectoryMode mode,
+                       double start_time_sec)
+    : points_(std::move(points)), mode_(mode), start_time_sec_(start_time_sec)
+{
+}
+
+bool Trajectory::isValid() const
+{
+    if (points_.empty() || points_.front().time_sec < 0.0) return false;
+
+    for (size_t i = 1; i < points_.size(); i++)
+    {
+        if (!(points_[i].time_sec > points_[i - 1].time_sec)) return false;
+    }
+
+    return true;
+}
+
+void Trajectory::evaluate(double time_sec, TrajectoryPoint& point) const
+{
+    double t = time_sec - start_time_sec_;
+
+    if (t <= points_.front().time_sec)
+    {
+        point = points_.front();
+        return;
+    }
+
+    if (t >= points_.back().time_sec)
+    {
+        point = points_.back();
+        return;
+    }
+
+    // first waypoint after t, there is always one before it
+    auto next = std::upper_bound(
+        points_.begin(), points_.end(), t, [](double time, const TrajectoryPoint& p) {
+            return time < p.time_sec;
+        });
+    const TrajectoryPoint& p0 = *(next - 1);
+    const TrajectoryPoint& p1 = *next;
+
+    double T = p1.time_sec - p0.time_sec;
+    double T2 = T * T;
+    double T3 = T2 * T;
+    double dp = p1.position_rad - p0.position_rad;
+
+    // quintic hermite coefficients
+    double c0 = p0.position_rad;
+    double c1 = p0.velocity_rad_sec;
+    double c2 = 0.5 * p0.acceleration_rad_sec_sec;
+    double c3 = (20.0 * dp - (8.0 * p1.velocity_rad_sec + 12.0 * p0.velocity_rad_sec) * T
+                 - (3.0 * p0.acceleration_rad_sec_sec - p1.acceleration_rad_sec_sec) * T2)
+                / (2.0 * T3);
+    double c4 = (-30.0 * dp + (14.0 * p1.velocity_rad_sec + 16.0 * p0.velocity_rad_sec) * T
+                 + (3.0 * p0.acceleration_rad_sec_sec - 2.0 * p1.acceleration_rad_sec_sec) * T2)
+                / (2.0 * T3 * T);
+    double c5 = (12.0 * dp - 6.0 * (p1.velocity_rad_sec + p0.velocity_rad_sec) * T
+                 - (p0.acceleration_rad_sec_sec - p1.acceleration_rad_sec_sec) * T2)
+                / (2.0 * T3 * T2);
+
+    double s = t - p0.time_sec;
+
+    point.time_sec = t;
+    point.position_rad = c0 + s * (c1 + s * (c2 + s * (c3 + s * (c4 + s * c5))));
+    point.velocity_rad_sec =
+        c1 + s * (2.0 * c2 + s * (3.0 * c3 + s * (4.0 * c4 + s * 5.0 * c5)));
+    point.acceleration_rad_sec_sec =
+        2.0 * c2 + s * (6.0 * c3 + s * (12.0 * c4 + s * 20.0 * c5));
+}
+
+bool Trajectory::isFinished(double time_sec) const
+{
+    return time_sec - start_time_sec_ >= points_.back().time_sec;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+
+#include "PlatformDriverEthercatTypes.h"
+
+namespace platform_driver_ethercat
+{
+
+/**
+ * Time-parameterized joint trajectory.
+ * Consecutive waypoints are connected by quintic polynomials matching position, velocity and
+ * acceleration at both ends.
+ */
+class Trajectory
+{
+  public:
+    /**
+     * The constructor
+     * @param points Waypoints with strictly increasing time stamps.
+     * @param mode Set point type that is written to the drive.
+     * @param start_time_sec Monotonic time at which the trajectory starts.
+     */
+    Trajectory(std::vector<TrajectoryPoint> points, TrajectoryMode mode, double start_time_sec);
+
+    /**
+     * Checks that the trajectory is non-empty and its time stamps are strictly increasing.
+     * @return True if the trajectory can be executed.
+     */
+    bool isValid() const;
+
+    /**
+     * Interpolates the trajectory.
+     * Before the first waypoint the first waypoint is held, after the last waypoint the last
+     * waypoint is held.
+     * @param time_sec Monotonic time.
+     * @param point Interpolated position, velocity and acceleration.
+     */
+    void evaluate(double time_sec, TrajectoryPoint& point) const;
+
+    /**
+     * Checks if the trajectory has passed its last waypoint.
+     * @param time_sec Monotonic time.
+     * @return True if the trajectory is finished.
+     */
+    bool isFinished(double time_sec) const;
+
+    TrajectoryMode getMode() const { return mode_; };
+    double getStartTimeSec() const { return start_time_sec_; };
+
+  private:
+    std::vector<TrajectoryPoint> points_;
+    TrajectoryMode mode_;
+    double start_time_sec_;
+};
+}
@@ -0,0 +1,218 @@
+#include <unistd.h>
+#include <cstring>
+
+#include "SimulatedBus.h"
+#include "ethercat.h"
+
+using namespace platform_driver_ethercat;
+
+ec_slavet ec_slave[SIMULATED_BUS_MAX_SLAVES + 1];
+ec_groupt ec_group[2];
+int ec_slavecount = 0;
+boolean EcatError = FALSE;
+int64_t ec_DCtime = 0;
+
+namespace
+{
+const size_t PDO_SIZE = 64;
+
+// same layouts as the process data of CanDriveTwitter and CanDeviceAtiFts
+struct DriveOutputs
+{
+    uint16_t control_word;
+    uint16_t operation_mode;
+    int32_t target_position;
+    int32_t target_velocity;
+    int16_t target_torque;
+};
+
+struct DriveInputs
+{
+    uint16_t status_word;
+    uint8_t operation_mode_display;
+    int32_t actual_position;
+    int32_t actual_velocity;
+    int16_t actual_torque;
+    int16_t analog_input;
+    int32_t auxiliary_position;
+};
+
+struct FtsInputs
+{
+    int32_t wrench[6];
+    uint32_t status_code;
+    uint32_t sample_count;
+};
+
+std::string slave_types = "DDF";
+uint8_t outputs[SIMULATED_BUS_MAX_SLAVES + 1][PDO_SIZE];
+uint8_t inputs[SIMULATED_BUS_MAX_SLAVES + 1][PDO_SIZE];
+
+void updateDrive(const DriveOutputs& out, DriveInputs& in)
+{
+    // CiA402 state machine, the switch on sequence completes in one cycle
+    uint16_t command = out.control_word & 0x000f;
+
+    if (out.control_word & 0x0080)
+        in.status_word = 0x0040;  // fault reset, switch on disabled
+    else if (command == 0x000f)
+        in.status_word = 0x0027 | (in.status_word & 0x1000);  // operation enabled
+    else if (command == 0x0007)
+        in.status_word = 0x0023;  // switched on
+    else if (command == 0x0006)
+        in.status_word = 0x0021;  // ready to switch on
+    else
+        in.status_word = 0x0040;
+
+    // set point acknowledge follows the new set point bit
+    if (out.control_word & 0x0010)
+        in.status_word |= 0x1000;
+    else
+        in.status_word &= ~0x1000;
+
+    in.operation_mode_display = (uint8_t)out.operation_mode;
+
+    switch (out.operation_mode)
+    {
+        case 1:  // profile position
+        case 8:  // cyclic synchronous position
+            in.actual_position = out.target_position;
+            in.actual_velocity = 0;
+            break;
+        case 3:  // profile velocity
+        case 9:  // cyclic synchronous velocity
+            in.actual_velocity = out.target_velocity;
+            in.actual_position += out.target_velocity / 200;
+            break;
+        case 4:   // profile torque
+        case 10:  // cyclic synchronous torque
+            in.actual_velocity += out.target_torque * 20;
+            in.actual_position += in.actual_velocity / 200;
+            break;
+        default:
+            break;
+    }
+
+    in.actual_torque = out.target_torque;
+    in.auxiliary_position = (in.auxiliary_position + 3) % 4096;
+}
+
+void updateFts(FtsInputs& in)
+{
+    for (int i = 0; i < 6; i++)
+    {
+        in.wrench[i] = 1000 * (i + 1);
+    }
+
+    in.status_code = 0;
+    in.sample_count++;
+}
+}
+
+void platform_driver_ethercat::setSimulatedSlaves(const std::string& types)
+{
+    slave_types = types.substr(0, SIMULATED_BUS_MAX_SLAVES);
+}
+
+int ec_init(const char*) { return 1; }
+
+int ec_config_init(uint8_t)
+{
+    ec_slavecount = slave_types.size();
+
+    for (int i = 1; i <= ec_slavecount; i++)
+    {
+        ec_slave[i].state = EC_STATE_PRE_OP;
+        ec_slave[i].Ibytes = PDO_SIZE;
+        ec_slave[i].Obytes = PDO_SIZE;
+    }
+
+    return ec_slavecount;
+}
+
+int ec_config_map(void*)
+{
+    for (int i = 1; i <= ec_slavecount; i++)
+    {
+        ec_slave[i].inputs = inputs[i];
+        ec_slave[i].outputs = outputs[i];
+    }
+
+    ec_group[0].outputsWKC = ec_slavecount;
+    ec_group[0].inputsWKC = ec_slavecount;
+
+    return ec_slavecount * 2 * PDO_SIZE;
+}
+
+boolean ec_configdc(void) { return FALSE; }
+
+uint16_t ec_statecheck(uint16_t slave, uint16_t reqstate, int)
+{
+    ec_slave[slave].state = reqstate;
+
+    if (slave == 0)
+    {
+        for (int i = 1; i <= ec_slavecount; i++)
+        {
+            ec_slave[i].state = reqstate;
+        }
+    }
+
+    return reqstate;
+}
+
+int ec_send_processdata(void)
+{
+    // the slaves process the frame while it passes
+    for (int i = 1; i <= ec_slavecount; i++)
+    {
+        if (slave_types[i - 1] == 'D')
+        {
+            updateDrive(*reinterpret_cast<const DriveOutputs*>(outputs[i]),
+                        *reinterpret_cast<DriveInputs*>(inputs[i]));
+        }
+        else if (slave_types[i - 1] == 'F')
+        {
+            updateFts(*reinterpret_cast<FtsInputs*>(inputs[i]));
+        }
+    }
+
+    return 1;
+}
+
+int ec_receive_processdata(int)
+{
+    return ec_group[0].outputsWKC * 2 + ec_group[0].inputsWKC;
+}
+
+int ec_writestate(uint16_t) { return 1; }
+
+int ec_readstate(void) { return 1; }
+
+void ec_close(void) {}
+
+char* ec_elist2string(void)
+{
+    static char empty[1] = {0};
+
+    return empty;
+}
+
+const char* ec_ALstatuscode2string(uint16_t) { return ""; }
+
+int ec_reconfig_slave(uint16_t, int) { return EC_STATE_OPERATIONAL; }
+
+int ec_recover_slave(uint16_t, int) { return 1; }
+
+int ec_SDOread(uint16_t, uint16_t, uint8_t, boolean, int* psize, void* p, int)
+{
+    int32_t value = 1000000;
+    memcpy(p, &value, sizeof(value));
+    *psize = sizeof(value);
+
+    return 1;
+}
+
+int ec_SDOwrite(uint16_t, uint16_t, uint8_t, boolean, int, const void*, int) { return 1; }
+
+int osal_usleep(uint32_t usec) { return usleep(usec); }
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace platform_driver_ethercat
+{
+
+const size_t SIMULATED_BUS_MAX_SLAVES = 256;
+
+/**
+ * Configures the slaves of the simulated SOEM bus used by the tests.
+ * Drives follow their set points ideally, position and velocity set points are reached within
+ * one cycle and torque set points accelerate the drive. Sensors report a constant wrench with
+ * an incrementing sample counter. Must be called before the EtherCAT interface is initialized.
+ * @param slave_types One character per slave in slave order, 'D' for an Elmo Gold Twitter drive
+ * and 'F' for an ATI force-torque sensor.
+ */
+void setSimulatedSlaves(const std::string& slave_types);
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PlatformDriverEthercat.h"
+#include "SimulatedBus.h"
+
+using namespace platform_driver_ethercat;
+
+/**
+ * Measures the processing time of the EtherCAT cycle on the simulated bus, i.e. the device
+ * updates and the cycle callbacks, for a growing number of drives with and without workers.
+ * Every drive has an active joint. The bus simulation itself is not included, it runs in the
+ * send phase.
+ */
+
+namespace
+{
+const double RUN_SEC = 2.0;
+
+/**
+ * Runs a platform with the given number of drives and workers.
+ * @return False if the platform could not be initialized.
+ */
+bool runPlatform(size_t num_drives, size_t num_workers, CyclePhaseStats& stats)
+{
+    setSimulatedSlaves(std::string(num_drives, 'D'));
+
+    std::unique_ptr<PlatformDriverEthercat> platform(
+        new PlatformDriverEthercat("sim", num_drives));
+
+    DriveParams drive_params{-360, 360, 3000, 5, 2, 0.1, 100, 4096, false, 1, 1, 0};
+    ActiveJointParams joint_params{false, -1, 1, 2, 10, 0};
+
+    for (size_t i = 0; i < num_drives; i++)
+    {
+        std::string drive_name = "DRIVE_" + std::to_string(i + 1);
+
+        platform->addDriveTwitter(i + 1, drive_name, drive_params);
+        platform->addActiveJoint("JOINT_" + std::to_string(i + 1), drive_name, joint_params, true);
+    }
+
+    if (num_workers > 0)
+    {
+        platform->enableCycleWorkers(std::vector<int>(num_workers, -1));
+    }
+
+    if (!platform->initPlatform())
+    {
+        return false;
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(RUN_SEC));
+
+    return platform->readCyclePhaseStats(stats);
+}
+}
+
+int main()
+{
+    const size_t worker_counts[] = {0, 1, 3};
+
+    printf("%u CPUs, process time per cycle [us], mean / max\n",
+           std::thread::hardware_concurrency());
+    printf("%8s", "drives");
+
+    for (size_t num_workers : worker_counts)
+    {
+        printf("   %9zu workers", num_workers);
+    }
+
+    printf("\n");
+
+    for (size_t num_drives : {8, 32, 128, 256})
+    {
+        printf("%8zu", num_drives);
+
+        for (size_t num_workers : worker_counts)
+        {
+            CyclePhaseStats stats;
+
+            if (!runPlatform(num_drives, num_workers, stats))
+            {
+                printf("   %17s", "init failed");
+                continue;
+            }
+
+            printf("   %7.1f / %7.1f",
+                   stats.process.mean_sec * 1e6,
+                   stats.process.max_sec * 1e6);
+        }
+
+        printf("\n");
+        fflush(stdout);
+    }
+
+    return 0;
+}
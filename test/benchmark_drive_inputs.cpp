@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CanDriveTwitter.h"
+#include "EthercatInterface.h"
+#include "JointActive.h"
+
+using namespace platform_driver_ethercat;
+
+/**
+ * Compares two ways for the EtherCAT cycle to get the joint states in SI units, both on top of
+ * the update of real CanDriveTwitter instances:
+ * - drive reads: the joint update reads position, velocity and torque through the joints and
+ *   position, velocity and auxiliary position for the estimators from the drives, which
+ *   convert their raw inputs when read, as the platform does now
+ * - decode pass: one pass per cycle unwraps and converts the inputs of all drives into
+ *   structure of arrays, which the joint update reads directly, without locks or calls
+ * The drives still publish their raw inputs in the decode pass variant, so it carries a few
+ * relaxed stores per drive that a decode stage would save.
+ */
+
+namespace
+{
+const int NUM_CYCLES = 20000;
+const int NUM_RUNS = 5;
+
+const uint16_t STATUS_OPERATION_ENABLED = 0x0027;
+
+/**
+ * Same layout as the inputs of CanDriveTwitter.
+ */
+struct DriveInputs
+{
+    uint16_t status_word;
+    uint8_t operation_mode_display;
+    int32_t actual_position;
+    int32_t actual_velocity;
+    int16_t actual_torque;
+    int16_t analog_input;
+    int32_t auxiliary_position;
+};
+
+const size_t PDO_SIZE = 64;
+
+DriveParams makeParams(size_t drive)
+{
+    return DriveParams{-360, 360, 3000, 5, 2, 0.1, 100.0 + drive, 4096, drive % 2 == 0, 1, 1, 0};
+}
+
+/**
+ * Drives and joints with their process data, like the platform after initialization.
+ */
+struct Bus
+{
+    std::shared_ptr<EthercatInterface> ethercat;
+    std::vector<std::shared_ptr<CanDriveTwitter>> drives;
+    std::vector<std::unique_ptr<JointActive>> joints;
+    std::vector<unsigned char> inputs;
+    std::vector<unsigned char> outputs;
+
+    explicit Bus(size_t num_drives)
+        : ethercat(new EthercatInterface("sim", num_drives)),
+          inputs(num_drives * PDO_SIZE, 0),
+          outputs(num_drives * PDO_SIZE, 0)
+    {
+        ActiveJointParams joint_params{false, -1, 1, 2, 10, 0};
+
+        for (size_t i = 0; i < num_drives; i++)
+        {
+            std::string name = "DRIVE_" + std::to_string(i + 1);
+            std::shared_ptr<CanDriveTwitter> drive(
+                new CanDriveTwitter(ethercat, i + 1, name, makeParams(i)));
+
+            drive->setInputPdo(&inputs[i * PDO_SIZE]);
+            drive->setOutputPdo(&outputs[i * PDO_SIZE]);
+            drives.push_back(drive);
+            joints.emplace_back(new JointActive("JOINT_" + std::to_string(i + 1),
+                                                drives.back(),
+                                                joint_params,
+                                                true));
+        }
+    }
+
+    /**
+     * Writes the inputs of a cycle like a received frame.
+     */
+    void receive(int cycle)
+    {
+        for (size_t i = 0; i < drives.size(); i++)
+        {
+            DriveInputs pdo;
+            std::memcpy(&pdo, &inputs[i * PDO_SIZE], sizeof(pdo));
+
+            pdo.status_word = STATUS_OPERATION_ENABLED;
+            pdo.actual_position = 1000 * cycle + i;
+            pdo.actual_velocity = cycle - i;
+            pdo.actual_torque = (int16_t)(cycle + i);
+            pdo.auxiliary_position = (7 * cycle + i) % 4096;
+
+            std::memcpy(&inputs[i * PDO_SIZE], &pdo, sizeof(pdo));
+        }
+    }
+
+    void update(const CycleInfo& cycle)
+    {
+        for (auto& drive : drives)
+        {
+            drive->update(cycle);
+        }
+    }
+};
+
+/**
+ * Joint states of the cycle, as in the joint update of the platform.
+ */
+struct JointStates
+{
+    std::vector<double> positions_rad;
+    std::vector<double> velocities_rad_sec;
+    std::vector<double> torques_nm;
+    std::vector<double> estimator_inputs;
+
+    explicit JointStates(size_t num_joints)
+        : positions_rad(num_joints),
+          velocities_rad_sec(num_joints),
+          torques_nm(num_joints),
+          estimator_inputs(num_joints)
+    {
+    }
+};
+
+void readDrives(Bus& bus, JointStates& states)
+{
+    for (size_t i = 0; i < bus.joints.size(); i++)
+    {
+        bus.joints[i]->readPositionRad(states.positions_rad[i]);
+        bus.joints[i]->readVelocityRadSec(states.velocities_rad_sec[i]);
+        bus.joints[i]->readTorqueNm(states.torques_nm[i]);
+    }
+
+    for (size_t i = 0; i < bus.drives.size(); i++)
+    {
+        CanDriveTwitter& drive = *bus.drives[i];
+
+        states.estimator_inputs[i] = drive.readPositionRad() + drive.readVelocityRadSec()
+                                     + drive.readAuxiliaryPositionRad();
+    }
+}
+
+/**
+ * Decode stage over the process data of all drives, owned by the cycle.
+ */
+class DecodePass
+{
+  public:
+    explicit DecodePass(size_t num_drives)
+        : position_scales_(num_drives),
+          velocity_scales_(num_drives),
+          torque_scales_(num_drives),
+          aux_position_scales_(num_drives),
+          aux_increments_(num_drives, 4096),
+          flip_signs_(num_drives, 1.0),
+          last_positions_inc_(num_drives, 0),
+          last_aux_positions_inc_(num_drives, 0),
+          positions_inc_(num_drives, 0),
+          aux_positions_inc_(num_drives, 0),
+          velocities_inc_(num_drives, 0),
+          torques_(num_drives, 0),
+          positions_rad_(num_drives),
+          velocities_rad_sec_(num_drives),
+          torques_nm_(num_drives),
+          aux_positions_rad_(num_drives)
+    {
+        for (size_t i = 0; i < num_drives; i++)
+        {
+            DriveParams params = makeParams(i);
+            double increments = (params.encoder_on_output ? 1.0 : params.gear_ratio)
+                                * params.encoder_increments;
+
+            position_scales_[i] = 2.0 * M_PI / increments;
+            velocity_scales_[i] = 2.0 * M_PI / increments;
+            torque_scales_[i] = params.motor_rated_torque_nm / 1000.0 * params.gear_ratio;
+            aux_position_scales_[i] = 2.0 * M_PI / aux_increments_[i];
+        }
+    }
+
+    __attribute__((noinline)) void decode(const unsigned char* inputs)
+    {
+        size_t size = positions_rad_.size();
+
+        // gathers the raw inputs from the frame
+        for (size_t i = 0; i < size; i++)
+        {
+            DriveInputs pdo;
+            std::memcpy(&pdo, inputs + i * PDO_SIZE, sizeof(pdo));
+
+            positions_inc_[i] +=
+                (int32_t)((uint32_t)pdo.actual_position - (uint32_t)last_positions_inc_[i]);
+            last_positions_inc_[i] = pdo.actual_position;
+
+            int32_t delta_inc = pdo.auxiliary_position - last_aux_positions_inc_[i];
+            if (delta_inc >= aux_increments_[i] / 2)
+                delta_inc -= aux_increments_[i];
+            else if (delta_inc < -aux_increments_[i] / 2)
+                delta_inc += aux_increments_[i];
+            aux_positions_inc_[i] += delta_inc;
+            last_aux_positions_inc_[i] = pdo.auxiliary_position;
+
+            velocities_inc_[i] = pdo.actual_velocity;
+            torques_[i] = pdo.actual_torque;
+        }
+
+        for (size_t i = 0; i < size; i++)
+        {
+            positions_rad_[i] = positions_inc_[i] * position_scales_[i];
+            velocities_rad_sec_[i] = velocities_inc_[i] * velocity_scales_[i];
+            torques_nm_[i] = torques_[i] * torque_scales_[i];
+            aux_positions_rad_[i] = aux_positions_inc_[i] * aux_position_scales_[i];
+        }
+    }
+
+    void readJoints(JointStates& states) const
+    {
+        for (size_t i = 0; i < positions_rad_.size(); i++)
+        {
+            states.positions_rad[i] = flip_signs_[i] * positions_rad_[i];
+            states.velocities_rad_sec[i] = flip_signs_[i] * velocities_rad_sec_[i];
+            states.torques_nm[i] = flip_signs_[i] * torques_nm_[i];
+            states.estimator_inputs[i] =
+                positions_rad_[i] + velocities_rad_sec_[i] + aux_positions_rad_[i];
+        }
+    }
+
+  private:
+    std::vector<double> position_scales_;
+    std::vector<double> velocity_scales_;
+    std::vector<double> torque_scales_;
+    std::vector<double> aux_position_scales_;
+    std::vector<int32_t> aux_increments_;
+    std::vector<double> flip_signs_;
+
+    std::vector<int32_t> last_positions_inc_;
+    std::vector<int32_t> last_aux_positions_inc_;
+    std::vector<int64_t> positions_inc_;
+    std::vector<int64_t> aux_positions_inc_;
+    std::vector<int32_t> velocities_inc_;
+    std::vector<int16_t> torques_;
+
+    std::vector<double> positions_rad_;
+    std::vector<double> velocities_rad_sec_;
+    std::vector<double> torques_nm_;
+    std::vector<double> aux_positions_rad_;
+};
+
+/**
+ * Runs the cycles and returns the time per cycle, without the simulated frame.
+ * @param read Gets the joint states after the drives were updated.
+ */
+template <typename Read>
+double runCycles(Bus& bus, JointStates& states, Read read)
+{
+    CycleInfo cycle{0, 0.0, 0.0, 0.0, 0, 0, 0};
+    double duration_sec = 0.0;
+    double sum = 0.0;
+
+    for (int c = 1; c <= NUM_CYCLES; c++)
+    {
+        bus.receive(c);
+
+        cycle.sequence = c;
+        cycle.time_sec = c * 0.005;
+
+        auto start = std::chrono::steady_clock::now();
+
+        bus.update(cycle);
+        read();
+
+        duration_sec += std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                            .count();
+
+        sum += states.positions_rad.back() + states.estimator_inputs.back();
+    }
+
+    // keeps the compiler from dropping the reads
+    volatile double result = sum;
+    (void)result;
+
+    return duration_sec / NUM_CYCLES;
+}
+
+double benchmarkDriveReads(size_t num_drives)
+{
+    Bus bus(num_drives);
+    JointStates states(num_drives);
+
+    return runCycles(bus, states, [&] { readDrives(bus, states); });
+}
+
+double benchmarkDecodePass(size_t num_drives)
+{
+    Bus bus(num_drives);
+    JointStates states(num_drives);
+    DecodePass decode_pass(num_drives);
+
+    return runCycles(bus, states, [&] {
+        decode_pass.decode(bus.inputs.data());
+        decode_pass.readJoints(states);
+    });
+}
+
+/**
+ * Best of several runs, the least disturbed by other processes.
+ */
+double best(double (*benchmark)(size_t), size_t num_drives)
+{
+    double best_sec = benchmark(num_drives);
+
+    for (int run = 1; run < NUM_RUNS; run++)
+    {
+        best_sec = std::min(best_sec, benchmark(num_drives));
+    }
+
+    return best_sec;
+}
+}
+
+int main()
+{
+    printf("drive updates and joint states per cycle [ns]\n");
+    printf("%8s %12s %12s\n", "drives", "drive reads", "decode pass");
+
+    for (size_t num_drives : {4, 16, 64, 256})
+    {
+        printf("%8zu %12.1f %12.1f\n",
+               num_drives,
+               best(benchmarkDriveReads, num_drives) * 1e9,
+               best(benchmarkDecodePass, num_drives) * 1e9);
+    }
+
+    return 0;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+ * Subset of the SOEM API used by the driver, implemented by the simulated bus of the tests.
+ * Replaces the SOEM header for the test targets only.
+ */
+
+#include <stdint.h>
+
+typedef uint8_t boolean;
+
+#define FALSE 0
+#define TRUE 1
+
+#define EC_TIMEOUTRET 2000
+#define EC_TIMEOUTSTATE 2000000
+#define EC_TIMEOUTTXM 20000
+#define EC_TIMEOUTRXM 700000
+
+#define ECT_COEDET_SDOCA 0x08
+
+enum
+{
+    EC_STATE_NONE = 0x00,
+    EC_STATE_INIT = 0x01,
+    EC_STATE_PRE_OP = 0x02,
+    EC_STATE_BOOT = 0x03,
+    EC_STATE_SAFE_OP = 0x04,
+    EC_STATE_OPERATIONAL = 0x08,
+    EC_STATE_ACK = 0x10,
+    EC_STATE_ERROR = 0x10
+};
+
+typedef struct
+{
+    uint16_t state;
+    uint16_t ALstatuscode;
+    uint8_t* inputs;
+    uint8_t* outputs;
+    uint32_t Ibytes;
+    uint32_t Obytes;
+    uint8_t CoEdetails;
+    uint8_t group;
+    boolean islost;
+    boolean hasdc;
+} ec_slavet;
+
+typedef struct
+{
+    int outputsWKC;
+    int inputsWKC;
+    boolean docheckstate;
+} ec_groupt;
+
+extern ec_slavet ec_slave[];
+extern ec_groupt ec_group[];
+extern int ec_slavecount;
+extern boolean EcatError;
+extern int64_t ec_DCtime;
+
+int ec_init(const char* ifname);
+int ec_config_init(uint8_t usetable);
+int ec_config_map(void* pIOmap);
+boolean ec_configdc(void);
+uint16_t ec_statecheck(uint16_t slave, uint16_t reqstate, int timeout);
+int ec_send_processdata(void);
+int ec_receive_processdata(int timeout);
+int ec_writestate(uint16_t slave);
+int ec_readstate(void);
+void ec_close(void);
+char* ec_elist2string(void);
+const char* ec_ALstatuscode2string(uint16_t ALstatuscode);
+int ec_reconfig_slave(uint16_t slave, int timeout);
+int ec_recover_slave(uint16_t slave, int timeout);
+int ec_SDOread(uint16_t slave,
+               uint16_t index,
+               uint8_t subindex,
+               boolean CA,
+               int* psize,
+               void* p,
+               int timeout);
+int ec_SDOwrite(uint16_t slave,
+                uint16_t index,
+                uint8_t subindex,
+                boolean CA,
+                int psize,
+                const void* p,
+                int timeout);
+int osal_usleep(uint32_t usec);
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+#include "PlatformDriverEthercat.h"
+#include "SharedCommands.h"
+#include "SimulatedBus.h"
+
+using namespace platform_driver_ethercat;
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t num, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+
+namespace
+{
+const int NUM_CYCLES = 400;
+
+// allocations are counted while armed, on the cycle thread and in the marked API calls of the
+// test thread
+std::atomic<bool> armed(false);
+std::atomic<long> cycle_allocations(0);
+std::atomic<long> api_allocations(0);
+thread_local bool is_cycle_thread = false;
+thread_local bool in_api_call = false;
+
+void countAllocation()
+{
+    if (!armed.load(std::memory_order_relaxed)) return;
+
+    if (is_cycle_thread) cycle_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (in_api_call) api_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+}
+
+// every allocation of the process ends up in one of these, including operator new
+extern "C" void* malloc(size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t num, size_t size)
+{
+    countAllocation();
+    return __libc_calloc(num, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    countAllocation();
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void* memalign(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc(size_t alignment, size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    countAllocation();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+
+TEST(CycleAllocations, CycleAndHandleApisDoNotAllocate)
+{
+    setSimulatedSlaves("DDF");
+
+    std::unique_ptr<PlatformDriverEthercat> platform(new PlatformDriverEthercat("sim", 3));
+
+    DriveParams drive_params{-360, 360, 3000, 5, 2, 0.1, 100, 4096, false, 1, 1, 0};
+    platform->addDriveTwitter(1, "DRIVE_1", drive_params);
+    platform->addDriveTwitter(2, "DRIVE_2", drive_params);
+    platform->addAtiFts(3, "FTS");
+
+    ActiveJointParams joint_params{false, -1, 1, 2, 10, 0};
+    platform->addActiveJoint("ACTIVE", "DRIVE_1", joint_params, true);
+    platform->addPassiveJoint("PASSIVE", "DRIVE_2", true);
+
+    // every feature with work in the cycle
+    platform->addDriveTelemetry("DRIVE_1");
+    platform->addFtsTelemetry("FTS");
+    ASSERT_TRUE(platform->enableSharedState("/platform_driver_ethercat_test_state"));
+    ASSERT_TRUE(platform->enableSharedCommands("/platform_driver_ethercat_test_commands", 0.1));
+    ASSERT_TRUE(platform->enableJointEstimator("ACTIVE",
+                                               JointEstimatorParams{10, 0.001, 0.01, 0.001, 0.01}));
+    ASSERT_TRUE(platform->addJointGroup("GROUP", {"ACTIVE"}));
+    ASSERT_GE(platform->enableCycleEvents(1), 0);
+
+    std::atomic<long> controller_calls(0);
+    ASSERT_TRUE(platform->setCycleController(
+        [&controller_calls](const CycleControllerInput&, CycleControllerOutput& output)
+        {
+            is_cycle_thread = true;
+
+            // alternates between following the other commands and a velocity set point
+            if ((controller_calls.fetch_add(1) / 50) % 2)
+            {
+                output.velocities_rad_sec[0] = 0.1;
+            }
+        }));
+
+    ASSERT_TRUE(platform->initPlatform());
+    ASSERT_TRUE(platform->startupPlatform());
+
+    SharedCommandClient client;
+    ASSERT_TRUE(client.open("/platform_driver_ethercat_test_commands", 1));
+    SharedJointCommand shared_commands[2] = {{SharedCommandMode::TORQUE, 0.1},
+                                             {SharedCommandMode::NONE, 0.0}};
+
+    ASSERT_TRUE(platform->commandJointTrajectory(
+        "ACTIVE", {{0.0, 0.0, 0.0, 0.0}, {5.0, 0.5, 0.0, 0.0}}, TrajectoryMode::POSITION));
+
+    JointHandle joint;
+    ASSERT_TRUE(platform->getJointHandle("ACTIVE", joint));
+
+    double position_rad, velocity_rad_sec, torque_nm;
+    double positions_rad[2], velocities_rad_sec[2], torques_nm[2];
+    CycleStamp stamp;
+    JointEstimate estimate;
+    FtsSample wrenches[1];
+
+    // first calls may initialize loggers and other lazily created state
+    for (int cycle = 0; cycle < 20; cycle++)
+    {
+        platform->readJointStates(positions_rad, velocities_rad_sec, torques_nm, stamp);
+        platform->waitForNextCycle(1.0);
+    }
+
+    armed = true;
+
+    for (int cycle = 0; cycle < NUM_CYCLES; cycle++)
+    {
+        // name based APIs are allowed to allocate, they only drive the cycle through its paths
+        if (cycle % 40 == 0)
+        {
+            platform->stageJointGroupPositionRad("GROUP", 0, cycle % 80 ? 0.2 : NAN);
+            platform->commitJointGroup("GROUP");
+        }
+
+        if (cycle % 60 < 30)
+        {
+            client.command(shared_commands);
+        }
+
+        in_api_call = true;
+
+        switch (cycle % 3)
+        {
+            case 0: platform->commandJointPositionRad(joint, 0.1); break;
+            case 1: platform->commandJointVelocityRadSec(joint, 0.1); break;
+            case 2: platform->commandJointTorqueNm(joint, 0.1); break;
+        }
+
+        platform->readJointPositionRad(joint, position_rad);
+        platform->readJointVelocityRadSec(joint, velocity_rad_sec);
+        platform->readJointTorqueNm(joint, torque_nm);
+        platform->readJointState(joint, position_rad, velocity_rad_sec, torque_nm, stamp);
+        platform->readJointStates(positions_rad, velocities_rad_sec, torques_nm, stamp);
+        platform->readJointEstimate(joint, estimate);
+        platform->readFtsWrenches(wrenches, 1);
+        platform->commandJointPositionsRad(positions_rad);
+        platform->waitForNextCycle(1.0);
+
+        in_api_call = false;
+    }
+
+    armed = false;
+
+    EXPECT_GE(controller_calls.load(), NUM_CYCLES);
+    EXPECT_EQ(cycle_allocations.load(), 0);
+    EXPECT_EQ(api_allocations.load(), 0);
+}
+
+int main(int argc, char** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}